@@ -830,6 +830,26 @@ bool CBLSWorker::VerifySignatureVector(const BLSSignatureVector& sigs, size_t st
     return VerifyVectorHelper(sigs, start, count);
 }
 
+void CBLSWorker::RunJobsAndWait(const std::vector<std::function<void()>>& jobs)
+{
+    if (jobs.size() <= 1 || workerPool.size() == 0) {
+        for (const auto& job : jobs) {
+            job();
+        }
+        return;
+    }
+
+    std::list<std::future<void> > futures;
+    for (const auto& job : jobs) {
+        futures.emplace_back(workerPool.push([&job](int threadId) {
+            job();
+        }));
+    }
+    for (auto& f : futures) {
+        f.get();
+    }
+}
+
 void CBLSWorker::AsyncSign(const CBLSSecretKey& secKey, const uint256& msgHash, CBLSWorker::SignDoneCallback doneCallback)
 {
     workerPool.push([secKey, msgHash, doneCallback](int threadId) {
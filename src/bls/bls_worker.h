@@ -139,6 +139,10 @@ public:
     std::future<bool> AsyncVerifySig(const CBLSSignature& sig, const CBLSPublicKey& pubKey, const uint256& msgHash, CancelCond cancelCond = [] { return false; });
     bool IsAsyncVerifyInProgress();
 
+    // Runs independent jobs (e.g. externally built batch verifiers) on the worker pool and waits until all of them are
+    // finished. Jobs are executed on the calling thread if the worker pool is not running
+    void RunJobsAndWait(const std::vector<std::function<void()>>& jobs);
+
 private:
     void PushSigVerifyBatch();
 };
@@ -187,6 +187,26 @@ const CBlockIndex* LastCommonAncestor(const CBlockIndex* pa, const CBlockIndex*
     return pa;
 }
 
+CBlockLocator GetLocator(const CBlockIndex* pindex)
+{
+    int nStep = 1;
+    std::vector<uint256> vHave;
+    vHave.reserve(32);
+
+    while (pindex) {
+        vHave.push_back(pindex->GetBlockHash());
+        // Stop when we have added the genesis block.
+        if (pindex->nHeight == 0)
+            break;
+        // Exponentially larger steps back, plus the genesis block.
+        pindex = pindex->GetAncestor(std::max(pindex->nHeight - nStep, 0));
+        if (vHave.size() > 10)
+            nStep *= 2;
+    }
+
+    return CBlockLocator(vHave);
+}
+
 arith_uint256 CBlockIndex::GetBlockTrust() const
 {
     arith_uint256 bnTarget;
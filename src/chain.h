@@ -429,6 +429,8 @@ arith_uint256 GetBlockProof(const CBlockIndex& block);
 int64_t GetBlockProofEquivalentTime(const CBlockIndex& to, const CBlockIndex& from, const CBlockIndex& tip, const Consensus::Params&);
 /** Find the forking point between two chain tips. */
 const CBlockIndex* LastCommonAncestor(const CBlockIndex* pa, const CBlockIndex* pb);
+/** Return a CBlockLocator that refers to a block index entry. Only walks the skiplist, so it can be used without cs_main. */
+CBlockLocator GetLocator(const CBlockIndex* pindex);
 
 
 /** Used to marshal pointers into hashes for db storage. */
@@ -9,6 +9,8 @@
 #include <random.h>
 #include <version.h>
 
+#include <tuple>
+
 bool CCoinsView::GetCoin(const COutPoint &outpoint, Coin &coin) const { return false; }
 uint256 CCoinsView::GetBestBlock() const { return uint256(); }
 std::vector<uint256> CCoinsView::GetHeadBlocks() const { return std::vector<uint256>(); }
@@ -98,6 +100,16 @@ void AddCoins(CCoinsViewCache& cache, const CTransaction &tx, int nHeight, bool
     }
 }
 
+void CCoinsViewCache::WarmCoin(const COutPoint& outpoint, Coin&& coin) {
+    if (coin.IsSpent()) return;
+    CCoinsMap::iterator it;
+    bool inserted;
+    std::tie(it, inserted) = cacheCoins.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::forward_as_tuple(std::move(coin)));
+    if (inserted) {
+        cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
+    }
+}
+
 bool CCoinsViewCache::SpendCoin(const COutPoint &outpoint, Coin* moveout) {
     CCoinsMap::iterator it = FetchCoin(outpoint);
     if (it == cacheCoins.end()) return false;
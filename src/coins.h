@@ -272,6 +272,13 @@ public:
      */
     void AddCoin(const COutPoint& outpoint, Coin&& coin, bool potential_overwrite);
 
+    /**
+     * Cache a coin read from the backing view, unless the outpoint is already
+     * cached. The entry is neither DIRTY nor FRESH, so the state represented
+     * by this cache does not change; it only saves a later lookup.
+     */
+    void WarmCoin(const COutPoint& outpoint, Coin&& coin);
+
     /**
      * Spend a coin. Pass moveto in order to get the deleted data.
      * If no unspent output exists for the passed outpoint, this call
@@ -238,6 +238,46 @@ bool CDBIterator::Valid() const { return piter->Valid(); }
 void CDBIterator::SeekToFirst() { piter->SeekToFirst(); }
 void CDBIterator::Next() { piter->Next(); }
 
+void* CDBTransactionArena::Allocate(size_t size, size_t align)
+{
+    size_t pad = (align - (size_t)cur % align) % align;
+    if (pad + size > left) {
+        if (firstBlockFree && size + align <= DBWRAPPER_TRANSACTION_ARENA_BLOCK_SIZE) {
+            // Reuse the block kept by Reset()
+            firstBlockFree = false;
+            cur = blocks.front().first.get();
+            left = DBWRAPPER_TRANSACTION_ARENA_BLOCK_SIZE;
+        } else {
+            // Large items get a block of their own, so they don't waste the rest of the current block
+            size_t blockSize = std::max(DBWRAPPER_TRANSACTION_ARENA_BLOCK_SIZE, size + align);
+            blocks.emplace_back(std::unique_ptr<char[]>(new char[blockSize]), blockSize);
+            usage += blockSize;
+            cur = blocks.back().first.get();
+            left = blockSize;
+        }
+        pad = (align - (size_t)cur % align) % align;
+    }
+    char* p = cur + pad;
+    cur = p + size;
+    left -= pad + size;
+    return p;
+}
+
+void CDBTransactionArena::Reset()
+{
+    // Keep the first block if it is a regular one, it will likely be needed again
+    if (!blocks.empty() && blocks.front().second == DBWRAPPER_TRANSACTION_ARENA_BLOCK_SIZE) {
+        blocks.resize(1);
+        firstBlockFree = true;
+    } else {
+        blocks.clear();
+        firstBlockFree = false;
+    }
+    usage = blocks.empty() ? 0 : DBWRAPPER_TRANSACTION_ARENA_BLOCK_SIZE;
+    cur = nullptr;
+    left = 0;
+}
+
 namespace dbwrapper_private {
 
 void HandleError(const leveldb::Status& status)
@@ -22,6 +22,7 @@
 
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
+static const size_t DBWRAPPER_TRANSACTION_ARENA_BLOCK_SIZE = 64 * 1024;
 
 class dbwrapper_error : public std::runtime_error
 {
@@ -408,6 +409,55 @@ public:
 
 };
 
+/**
+ * Bump allocator for the pending changes of a CDBTransaction. Keys, map nodes and value holders are carved out of
+ * large blocks which are only released all at once, when the transaction is committed or cleared. One block is kept
+ * for the next round of changes, so a transaction that is committed after every block doesn't hit the heap at all
+ * for its bookkeeping.
+ */
+class CDBTransactionArena
+{
+private:
+    // blocks and their sizes, in allocation order
+    std::vector<std::pair<std::unique_ptr<char[]>, size_t>> blocks;
+    // whether blocks.front() was kept by Reset() and is not in use yet
+    bool firstBlockFree{false};
+    char* cur{nullptr};
+    size_t left{0};
+    size_t usage{0};
+
+public:
+    CDBTransactionArena() = default;
+    CDBTransactionArena(const CDBTransactionArena&) = delete;
+    CDBTransactionArena& operator=(const CDBTransactionArena&) = delete;
+
+    void* Allocate(size_t size, size_t align);
+    // Invalidates everything allocated so far
+    void Reset();
+    size_t DynamicMemoryUsage() const { return usage; }
+};
+
+template <typename T>
+class CDBTransactionArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    CDBTransactionArena* arena;
+
+    explicit CDBTransactionArenaAllocator(CDBTransactionArena& _arena) : arena(&_arena) {}
+    template <typename U>
+    CDBTransactionArenaAllocator(const CDBTransactionArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const CDBTransactionArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const CDBTransactionArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
 template<typename CDBTransaction>
 class CDBTransactionIterator
 {
@@ -490,7 +540,7 @@ public:
         } else {
             try {
                 // TODO try to avoid this copy (we need a stream that allows reading from external buffers)
-                CDataStream ssKey = transactionIt->first;
+                CDataStream ssKey = transactionIt->first.ToDataStream();
                 ssKey >> key;
             } catch (const std::exception&) {
                 return false;
@@ -506,7 +556,7 @@ public:
         if (curIsParent) {
             return parentKey;
         } else {
-            return transactionIt->first;
+            return transactionIt->first.ToDataStream();
         }
     }
 
@@ -517,7 +567,7 @@ public:
         if (curIsParent) {
             return parentIt->GetKeySize();
         } else {
-            return transactionIt->first.vKey.size();
+            return transactionIt->first.size();
         }
     }
 
@@ -529,7 +579,7 @@ public:
         if (curIsParent) {
             return transaction.Read(parentKey, value);
         } else {
-            return transaction.Read(transactionIt->first, value);
+            return CDBTransaction::GetHeldValue(*transactionIt->second, value);
         }
     };
 
@@ -550,7 +600,7 @@ private:
         } else if (transactionIt == transaction.writes.end() && parentIt->Valid()) {
             curIsParent = true;
         } else if (transactionIt != transaction.writes.end() && parentIt->Valid()) {
-            if (CDBTransaction::DataStreamCmp::less(transactionIt->first, parentKey)) {
+            if (CDBTransaction::KeyCmp::less(transactionIt->first, parentKey)) {
                 curIsParent = false;
             } else {
                 curIsParent = true;
@@ -566,15 +616,34 @@ class CDBTransaction {
 protected:
     Parent &parent;
     CommitTarget &commitTarget;
+    // serialized size of the pending values. Keys and bookkeeping are accounted by the arena
     ssize_t memoryUsage{0}; // signed, just in case we made an error in the calculations so that we don't get an overflow
 
-    struct DataStreamCmp {
-        static bool less(const CDataStream& a, const CDataStream& b) {
+    // Must be declared before the containers allocating from it
+    CDBTransactionArena arena;
+
+    // A serialized key copied into the arena
+    struct KeyRef {
+        const char* pdata;
+        size_t nSize;
+
+        const char* data() const { return pdata; }
+        size_t size() const { return nSize; }
+        CDataStream ToDataStream() const { return CDataStream(pdata, pdata + nSize, SER_DISK, CLIENT_VERSION); }
+    };
+
+    // Orders keys by their serialization. Transparent, so CDataStream keys can be looked up without copying them
+    struct KeyCmp {
+        typedef void is_transparent;
+
+        template <typename A, typename B>
+        static bool less(const A& a, const B& b) {
             return std::lexicographical_compare(
                     (const uint8_t*)a.data(), (const uint8_t*)a.data() + a.size(),
                     (const uint8_t*)b.data(), (const uint8_t*)b.data() + b.size());
         }
-        bool operator()(const CDataStream& a, const CDataStream& b) const {
+        template <typename A, typename B>
+        bool operator()(const A& a, const B& b) const {
             return less(a, b);
         }
     };
@@ -585,7 +654,11 @@ protected:
         virtual ~ValueHolder() = default;
         virtual void Write(const CDataStream& ssKey, CommitTarget &parent) = 0;
     };
-    typedef std::unique_ptr<ValueHolder> ValueHolderPtr;
+    // Holders live in the arena, so they are destroyed but not freed
+    struct ValueHolderDeleter {
+        void operator()(ValueHolder* p) const { p->~ValueHolder(); }
+    };
+    typedef std::unique_ptr<ValueHolder, ValueHolderDeleter> ValueHolderPtr;
 
     template <typename V>
     struct ValueHolderImpl : ValueHolder {
@@ -607,14 +680,36 @@ protected:
         return ssKey;
     }
 
-    typedef std::map<CDataStream, ValueHolderPtr, DataStreamCmp> WritesMap;
-    typedef std::set<CDataStream, DataStreamCmp> DeletesSet;
+    template <typename V>
+    static bool GetHeldValue(const ValueHolder& holder, V& value) {
+        auto *impl = dynamic_cast<const ValueHolderImpl<V> *>(&holder);
+        if (!impl) {
+            throw std::runtime_error("Read called with V != previously written type");
+        }
+        value = impl->value;
+        return true;
+    }
+
+    typedef std::map<KeyRef, ValueHolderPtr, KeyCmp, CDBTransactionArenaAllocator<std::pair<const KeyRef, ValueHolderPtr>>> WritesMap;
+    typedef std::set<KeyRef, KeyCmp, CDBTransactionArenaAllocator<KeyRef>> DeletesSet;
 
     WritesMap writes;
     DeletesSet deletes;
 
+    KeyRef CopyKey(const CDataStream& ssKey) {
+        char* p = static_cast<char*>(arena.Allocate(ssKey.size(), 1));
+        std::copy(ssKey.begin(), ssKey.end(), p);
+        return KeyRef{p, ssKey.size()};
+    }
+
 public:
-    CDBTransaction(Parent &_parent, CommitTarget &_commitTarget) : parent(_parent), commitTarget(_commitTarget) {}
+    CDBTransaction(Parent &_parent, CommitTarget &_commitTarget) :
+        parent(_parent),
+        commitTarget(_commitTarget),
+        writes(KeyCmp(), typename WritesMap::allocator_type(arena)),
+        deletes(KeyCmp(), typename DeletesSet::allocator_type(arena))
+    {
+    }
 
     template <typename K, typename V>
     void Write(const K& key, const V& v) {
@@ -625,16 +720,28 @@ public:
     void Write(const CDataStream& ssKey, const V& v) {
         auto valueMemoryUsage = ::GetSerializeSize(v);
 
-        if (deletes.erase(ssKey)) {
-            memoryUsage -= ssKey.size();
+        auto itDel = deletes.find(ssKey);
+        if (itDel != deletes.end()) {
+            deletes.erase(itDel);
         }
-        auto it = writes.emplace(ssKey, nullptr).first;
-        if (it->second) {
-            memoryUsage -= ssKey.size() + it->second->memoryUsage;
+        auto it = writes.lower_bound(ssKey);
+        if (it != writes.end() && !KeyCmp::less(ssKey, it->first)) {
+            memoryUsage -= it->second->memoryUsage;
+            auto *impl = dynamic_cast<ValueHolderImpl<V> *>(it->second.get());
+            if (impl) {
+                // overwriting with the same type, reuse the holder
+                impl->value = v;
+                impl->memoryUsage = valueMemoryUsage;
+                memoryUsage += valueMemoryUsage;
+                return;
+            }
+        } else {
+            it = writes.emplace_hint(it, CopyKey(ssKey), nullptr);
         }
-        it->second = std::make_unique<ValueHolderImpl<V>>(v, valueMemoryUsage);
+        void* p = arena.Allocate(sizeof(ValueHolderImpl<V>), alignof(ValueHolderImpl<V>));
+        it->second = ValueHolderPtr(new (p) ValueHolderImpl<V>(v, valueMemoryUsage));
 
-        memoryUsage += ssKey.size() + valueMemoryUsage;
+        memoryUsage += valueMemoryUsage;
     }
 
     template <typename K, typename V>
@@ -650,12 +757,7 @@ public:
 
         auto it = writes.find(ssKey);
         if (it != writes.end()) {
-            auto *impl = dynamic_cast<ValueHolderImpl<V> *>(it->second.get());
-            if (!impl) {
-                throw std::runtime_error("Read called with V != previously written type");
-            }
-            value = impl->value;
-            return true;
+            return GetHeldValue(*it->second, value);
         }
 
         return parent.Read(ssKey, value);
@@ -686,26 +788,35 @@ public:
     void Erase(const CDataStream& ssKey) {
         auto it = writes.find(ssKey);
         if (it != writes.end()) {
-            memoryUsage -= ssKey.size() + it->second->memoryUsage;
+            memoryUsage -= it->second->memoryUsage;
             writes.erase(it);
         }
-        if (deletes.emplace(ssKey).second) {
-            memoryUsage += ssKey.size();
+        auto itDel = deletes.lower_bound(ssKey);
+        if (itDel == deletes.end() || KeyCmp::less(ssKey, *itDel)) {
+            deletes.emplace_hint(itDel, CopyKey(ssKey));
         }
     }
 
     void Clear() {
         writes.clear();
         deletes.clear();
+        arena.Reset();
         memoryUsage = 0;
     }
 
     void Commit() {
+        // one key buffer for all entries, the commit target copies what it keeps
+        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+        ssKey.reserve(DBWRAPPER_PREALLOC_KEY_SIZE);
         for (const auto &k : deletes) {
-            commitTarget.Erase(k);
+            ssKey.clear();
+            ssKey.write(k.data(), k.size());
+            commitTarget.Erase(ssKey);
         }
         for (auto &p : writes) {
-            p.second->Write(p.first, commitTarget);
+            ssKey.clear();
+            ssKey.write(p.first.data(), p.first.size());
+            p.second->Write(ssKey, commitTarget);
         }
         Clear();
     }
@@ -722,9 +833,9 @@ public:
                 LogPrintf("CDBTransaction::%s -- negative memoryUsage (%d)", __func__, memoryUsage);
                 didPrint = true;
             }
-            return 0;
+            return arena.DynamicMemoryUsage();
         }
-        return (size_t)memoryUsage;
+        return arena.DynamicMemoryUsage() + (size_t)memoryUsage;
     }
 
     CDBTransactionIterator<CDBTransaction>* NewIterator() {
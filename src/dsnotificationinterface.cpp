@@ -15,6 +15,7 @@
 
 #include "evo/deterministicmns.h"
 #include "evo/mnauth.h"
+#include "evo/simplifiedmns.h"
 
 #include "llmq/quorums.h"
 #include "llmq/quorums_chainlocks.h"
@@ -61,6 +62,7 @@ void CDSNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindexNew, con
         return;
 
     CPrivateSend::UpdatedBlockTip(pindexNew);
+    CacheSimplifiedMNListDiffForTip(pindexNew);
 #ifdef ENABLE_WALLET
     privateSendClient.UpdatedBlockTip(pindexNew);
 #endif // ENABLE_WALLET
@@ -45,7 +45,7 @@ bool CheckCbTx(const CTransaction& tx, const CBlockIndex* pindexPrev, CValidatio
     return true;
 }
 
-// This can only be done after the block has been fully processed, as otherwise we won't have the finished MN list
+// The roots are recalculated from the lists at pindex->pprev and the block itself, so this does not need the block to be processed
 bool CheckCbTxMerkleRoots(const CBlock& block, const CBlockIndex* pindex, CValidationState& state)
 {
     bool isProofOfStake = !block.IsProofOfWork();
@@ -103,42 +103,45 @@ bool CalcCbTxMerkleRootMNList(const CBlock& block, const CBlockIndex* pindexPrev
     LOCK(deterministicMNManager->cs);
 
     static int64_t nTimeDMN = 0;
-    static int64_t nTimeSMNL = 0;
+    static int64_t nTimeDiff = 0;
     static int64_t nTimeMerkle = 0;
 
     int64_t nTime1 = GetTimeMicros();
 
+    // When connecting a block, CDeterministicMNManager::ProcessBlock reuses this list instead of building it again,
+    // so this is where its debug logs come from now
     CDeterministicMNList tmpMNList;
-    if (!deterministicMNManager->BuildNewListFromBlock(block, pindexPrev, state, tmpMNList, false)) {
+    if (!deterministicMNManager->BuildNewListFromBlock(block, pindexPrev, state, tmpMNList, true)) {
         return false;
     }
 
     int64_t nTime2 = GetTimeMicros(); nTimeDMN += nTime2 - nTime1;
     LogPrint(BCLog::BNCH, "            - BuildNewListFromBlock: %.2fms [%.2fs]\n", 0.001 * (nTime2 - nTime1), nTimeDMN * 0.000001);
 
-    CSimplifiedMNList sml(tmpMNList);
+    // The tree is kept for the last list it was calculated for and updated with the diff to the new list,
+    // so only changed entries are rehashed. This is protected by deterministicMNManager->cs
+    static CSimplifiedMNListMerkleTree smlTreeCached;
+    static CDeterministicMNList smlTreeListCached;
+    static bool smlTreeValid{false};
 
-    int64_t nTime3 = GetTimeMicros(); nTimeSMNL += nTime3 - nTime2;
-    LogPrint(BCLog::BNCH, "            - CSimplifiedMNList: %.2fms [%.2fs]\n", 0.001 * (nTime3 - nTime2), nTimeSMNL * 0.000001);
+    if (!smlTreeValid) {
+        smlTreeCached.Build(tmpMNList);
+        smlTreeValid = true;
+    } else {
+        auto diff = smlTreeListCached.BuildDiff(tmpMNList);
 
-    static CSimplifiedMNList smlCached;
-    static uint256 merkleRootCached;
-    static bool mutatedCached{false};
+        int64_t nTime3 = GetTimeMicros(); nTimeDiff += nTime3 - nTime2;
+        LogPrint(BCLog::BNCH, "            - BuildDiff: %.2fms [%.2fs]\n", 0.001 * (nTime3 - nTime2), nTimeDiff * 0.000001);
 
-    if (sml.mnList == smlCached.mnList) {
-        merkleRootRet = merkleRootCached;
-        return !mutatedCached;
+        smlTreeCached.ApplyDiff(smlTreeListCached, tmpMNList, diff);
     }
+    smlTreeListCached = tmpMNList;
 
     bool mutated = false;
-    merkleRootRet = sml.CalcMerkleRoot(&mutated);
-
-    int64_t nTime4 = GetTimeMicros(); nTimeMerkle += nTime4 - nTime3;
-    LogPrint(BCLog::BNCH, "            - CalcMerkleRoot: %.2fms [%.2fs]\n", 0.001 * (nTime4 - nTime3), nTimeMerkle * 0.000001);
+    merkleRootRet = smlTreeCached.GetMerkleRoot(&mutated);
 
-    smlCached = std::move(sml);
-    merkleRootCached = merkleRootRet;
-    mutatedCached = mutated;
+    int64_t nTime4 = GetTimeMicros(); nTimeMerkle += nTime4 - nTime2;
+    LogPrint(BCLog::BNCH, "            - CalcMerkleRoot: %.2fms [%.2fs]\n", 0.001 * (nTime4 - nTime2), nTimeMerkle * 0.000001);
 
     return !mutated;
 }
@@ -8,6 +8,7 @@
 #include "base58.h"
 #include "chain.h"
 #include "chainparams.h"
+#include "consensus/merkle.h"
 #include "core_io.h"
 #include "key_io.h"
 #include "script/standard.h"
@@ -200,35 +201,17 @@ static int CompareByLastPaid_GetHeight(const CDeterministicMN& dmn)
     return height;
 }
 
-static bool CompareByLastPaid(const CDeterministicMN& _a, const CDeterministicMN& _b)
+static CDeterministicMNList::MnPaymentKey CompareByLastPaid_GetKey(const CDeterministicMN& dmn)
 {
-    int ah = CompareByLastPaid_GetHeight(_a);
-    int bh = CompareByLastPaid_GetHeight(_b);
-    if (ah == bh) {
-        return _a.proTxHash < _b.proTxHash;
-    } else {
-        return ah < bh;
-    }
-}
-static bool CompareByLastPaid(const CDeterministicMNCPtr& _a, const CDeterministicMNCPtr& _b)
-{
-    return CompareByLastPaid(*_a, *_b);
+    return std::make_pair(CompareByLastPaid_GetHeight(dmn), dmn.proTxHash);
 }
 
 CDeterministicMNCPtr CDeterministicMNList::GetMNPayee() const
 {
-    if (mnMap.size() == 0) {
+    if (mnPaymentOrder.empty()) {
         return nullptr;
     }
-
-    CDeterministicMNCPtr best;
-    ForEachMN(true, [&](const CDeterministicMNCPtr& dmn) {
-        if (!best || CompareByLastPaid(dmn, best)) {
-            best = dmn;
-        }
-    });
-
-    return best;
+    return GetMN(mnPaymentOrder.front().second);
 }
 
 std::vector<CDeterministicMNCPtr> CDeterministicMNList::GetProjectedMNPayees(int nCount) const
@@ -240,14 +223,10 @@ std::vector<CDeterministicMNCPtr> CDeterministicMNList::GetProjectedMNPayees(int
     std::vector<CDeterministicMNCPtr> result;
     result.reserve(nCount);
 
-    ForEachMN(true, [&](const CDeterministicMNCPtr& dmn) {
-        result.emplace_back(dmn);
-    });
-    std::sort(result.begin(), result.end(), [&](const CDeterministicMNCPtr& a, const CDeterministicMNCPtr& b) {
-        return CompareByLastPaid(a, b);
-    });
-
-    result.resize(nCount);
+    // mnPaymentOrder is sorted in payment order, so the next payees are simply the first entries
+    for (auto it = mnPaymentOrder.begin(); (int)result.size() < nCount; ++it) {
+        result.emplace_back(GetMN(it->second));
+    }
 
     return result;
 }
@@ -276,13 +255,16 @@ std::vector<CDeterministicMNCPtr> CDeterministicMNList::CalculateQuorum(size_t m
 
 std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> CDeterministicMNList::CalculateScores(const uint256& modifier) const
 {
+    static const uint8_t validAndConfirmed = CDeterministicMNListScan::VALID | CDeterministicMNListScan::CONFIRMED;
+
+    auto scan = GetScan();
     std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> scores;
-    scores.reserve(GetAllMNsCount());
-    ForEachMN(true, [&](const CDeterministicMNCPtr& dmn) {
-        if (dmn->pdmnState->confirmedHash.IsNull()) {
+    scores.reserve(scan->size());
+    for (size_t i = 0; i < scan->size(); i++) {
+        if ((scan->flags[i] & validAndConfirmed) != validAndConfirmed) {
             // we only take confirmed MNs into account to avoid hash grinding on the ProRegTxHash to sneak MNs into a
             // future quorums
-            return;
+            continue;
         }
         // calculate sha256(sha256(proTxHash, confirmedHash), modifier) per MN
         // Please note that this is not a double-sha256 but a single-sha256
@@ -290,12 +272,13 @@ std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> CDeterministicMNList
         // TODO When https://github.com/bitcoin/bitcoin/pull/13191 gets backported, implement something that is similar but for single-sha256
         uint256 h;
         CSHA256 sha256;
-        sha256.Write(dmn->pdmnState->confirmedHashWithProRegTxHash.begin(), dmn->pdmnState->confirmedHashWithProRegTxHash.size());
+        const uint256& confirmedHashWithProRegTxHash = scan->confirmedHashesWithProRegTxHash[i];
+        sha256.Write(confirmedHashWithProRegTxHash.begin(), confirmedHashWithProRegTxHash.size());
         sha256.Write(modifier.begin(), modifier.size());
         sha256.Finalize(h.begin());
 
-        scores.emplace_back(UintToArith256(h), dmn);
-    });
+        scores.emplace_back(UintToArith256(h), scan->dmns[i]);
+    }
 
     return scores;
 }
@@ -436,9 +419,58 @@ CDeterministicMNList CDeterministicMNList::ApplyDiff(const CBlockIndex* pindex,
     return result;
 }
 
+CDeterministicMNListScan::CDeterministicMNListScan(const CDeterministicMNList& mnList)
+{
+    dmns.reserve(mnList.GetAllMNsCount());
+    mnList.ForEachMN(false, [&](const CDeterministicMNCPtr& dmn) {
+        dmns.emplace_back(dmn);
+    });
+    std::sort(dmns.begin(), dmns.end(), [](const CDeterministicMNCPtr& a, const CDeterministicMNCPtr& b) {
+        return a->proTxHash < b->proTxHash;
+    });
+
+    proTxHashes.reserve(dmns.size());
+    flags.reserve(dmns.size());
+    confirmedHashesWithProRegTxHash.reserve(dmns.size());
+    for (const auto& dmn : dmns) {
+        uint8_t f = 0;
+        if (mnList.IsMNValid(dmn)) {
+            f |= VALID;
+        }
+        if (!dmn->pdmnState->confirmedHash.IsNull()) {
+            f |= CONFIRMED;
+        }
+        proTxHashes.emplace_back(dmn->proTxHash);
+        flags.emplace_back(f);
+        confirmedHashesWithProRegTxHash.emplace_back(dmn->pdmnState->confirmedHashWithProRegTxHash);
+    }
+}
+
+CDeterministicMNListScanCPtr CDeterministicMNList::GetScan() const
+{
+    LOCK(scanSlot->cs);
+    if (!scanSlot->scan) {
+        scanSlot->scan = std::make_shared<const CDeterministicMNListScan>(*this);
+    }
+    return scanSlot->scan;
+}
+
+void CDeterministicMNList::ResetScan()
+{
+    // Only copies made from this list can share its slot, and none can be made while it is being
+    // modified, so a slot that isn't shared can simply be emptied
+    if (scanSlot.use_count() == 1) {
+        LOCK(scanSlot->cs);
+        scanSlot->scan.reset();
+    } else {
+        scanSlot = std::make_shared<ScanSlot>();
+    }
+}
+
 void CDeterministicMNList::AddMN(const CDeterministicMNCPtr& dmn)
 {
     assert(!mnMap.find(dmn->proTxHash));
+    ResetScan();
     mnMap = mnMap.set(dmn->proTxHash, dmn);
     mnInternalIdMap = mnInternalIdMap.set(dmn->internalId, dmn->proTxHash);
     AddUniqueProperty(dmn, dmn->collateralOutpoint);
@@ -449,6 +481,7 @@ void CDeterministicMNList::AddMN(const CDeterministicMNCPtr& dmn)
     if (dmn->pdmnState->pubKeyOperator.Get().IsValid()) {
         AddUniqueProperty(dmn, dmn->pdmnState->pubKeyOperator);
     }
+    AddToPaymentOrder(dmn);
 }
 
 void CDeterministicMNList::UpdateMN(const CDeterministicMNCPtr& oldDmn, const CDeterministicMNStateCPtr& pdmnState)
@@ -458,6 +491,12 @@ void CDeterministicMNList::UpdateMN(const CDeterministicMNCPtr& oldDmn, const CD
     auto oldState = dmn->pdmnState;
     dmn->pdmnState = pdmnState;
     mnMap = mnMap.set(oldDmn->proTxHash, dmn);
+    ResetScan();
+
+    if (IsMNValid(oldDmn) != IsMNValid(dmn) || CompareByLastPaid_GetKey(*oldDmn) != CompareByLastPaid_GetKey(*dmn)) {
+        RemoveFromPaymentOrder(oldDmn);
+        AddToPaymentOrder(dmn);
+    }
 
     UpdateUniqueProperty(dmn, oldState->addr, pdmnState->addr);
     UpdateUniqueProperty(dmn, oldState->keyIDOwner, pdmnState->keyIDOwner);
@@ -492,10 +531,34 @@ void CDeterministicMNList::RemoveMN(const uint256& proTxHash)
     if (dmn->pdmnState->pubKeyOperator.Get().IsValid()) {
         DeleteUniqueProperty(dmn, dmn->pdmnState->pubKeyOperator);
     }
+    RemoveFromPaymentOrder(dmn);
     mnMap = mnMap.erase(proTxHash);
+    ResetScan();
     mnInternalIdMap = mnInternalIdMap.erase(dmn->internalId);
 }
 
+void CDeterministicMNList::AddToPaymentOrder(const CDeterministicMNCPtr& dmn)
+{
+    if (!IsMNValid(dmn)) {
+        return;
+    }
+    auto key = CompareByLastPaid_GetKey(*dmn);
+    auto it = std::lower_bound(mnPaymentOrder.begin(), mnPaymentOrder.end(), key);
+    assert(it == mnPaymentOrder.end() || *it != key);
+    mnPaymentOrder = mnPaymentOrder.insert(it - mnPaymentOrder.begin(), key);
+}
+
+void CDeterministicMNList::RemoveFromPaymentOrder(const CDeterministicMNCPtr& dmn)
+{
+    if (!IsMNValid(dmn)) {
+        return;
+    }
+    auto key = CompareByLastPaid_GetKey(*dmn);
+    auto it = std::lower_bound(mnPaymentOrder.begin(), mnPaymentOrder.end(), key);
+    assert(it != mnPaymentOrder.end() && *it == key);
+    mnPaymentOrder = mnPaymentOrder.erase(it - mnPaymentOrder.begin());
+}
+
 CDeterministicMNManager::CDeterministicMNManager(CEvoDB& _evoDb) :
     evoDb(_evoDb)
 {
@@ -511,6 +574,8 @@ bool CDeterministicMNManager::ProcessBlock(const CBlock& block, const CBlockInde
         return true;
     }
 
+    static int64_t nTimeBuild = 0;
+
     CDeterministicMNList oldList, newList;
     CDeterministicMNListDiff diff;
 
@@ -519,10 +584,15 @@ bool CDeterministicMNManager::ProcessBlock(const CBlock& block, const CBlockInde
     {
         LOCK(cs);
 
+        int64_t nTime1 = GetTimeMicros();
+
         if (!BuildNewListFromBlock(block, pindex->pprev, _state, newList, true)) {
             return false;
         }
 
+        int64_t nTime2 = GetTimeMicros(); nTimeBuild += nTime2 - nTime1;
+        LogPrint(BCLog::BNCH, "          - BuildNewListFromBlock: %.2fms [%.2fs]\n", 0.001 * (nTime2 - nTime1), nTimeBuild * 0.000001);
+
         if (fJustCheck) {
             return true;
         }
@@ -614,6 +684,17 @@ bool CDeterministicMNManager::BuildNewListFromBlock(const CBlock& block, const C
 {
     AssertLockHeld(cs);
 
+    // the list only depends on the block's transactions, whether nNonce is 0 (which tells where the special txes
+    // start, see vtxOffset below) and the list at pindexPrev. The header hash can't be used as key, as
+    // hashMerkleRoot is not filled in yet for block templates. The transaction count is part of the key as mutated
+    // transaction lists (CVE-2012-2459) share the merkle root
+    const uint256 merkleRoot = BlockMerkleRoot(block);
+    if (merkleRoot == lastBuiltList.merkleRoot && block.vtx.size() == lastBuiltList.txCount &&
+        (block.nNonce == 0) == lastBuiltList.fZeroNonce && pindexPrev->GetBlockHash() == lastBuiltList.prevBlockHash) {
+        mnListRet = lastBuiltList.mnList;
+        return true;
+    }
+
     int nHeight = pindexPrev->nHeight + 1;
 
     CDeterministicMNList oldList = GetListForBlock(pindexPrev);
@@ -846,6 +927,12 @@ bool CDeterministicMNManager::BuildNewListFromBlock(const CBlock& block, const C
         newList.UpdateMN(payee->proTxHash, newState);
     }
 
+    lastBuiltList.merkleRoot = merkleRoot;
+    lastBuiltList.txCount = block.vtx.size();
+    lastBuiltList.fZeroNonce = block.nNonce == 0;
+    lastBuiltList.prevBlockHash = pindexPrev->GetBlockHash();
+    lastBuiltList.mnList = newList;
+
     mnListRet = std::move(newList);
 
     return true;
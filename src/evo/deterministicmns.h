@@ -13,6 +13,7 @@
 #include "simplifiedmns.h"
 #include "sync.h"
 
+#include "immer/flex_vector.hpp"
 #include "immer/map.hpp"
 #include "immer/map_transient.hpp"
 
@@ -233,8 +234,36 @@ public:
 typedef std::shared_ptr<CDeterministicMN> CDeterministicMNPtr;
 typedef std::shared_ptr<const CDeterministicMN> CDeterministicMNCPtr;
 
+class CDeterministicMNList;
 class CDeterministicMNListDiff;
 
+/**
+ * Flat copy of the fields read by whole-list scans, in proTxHash order. Scanning these arrays
+ * touches a few contiguous cache lines per MN instead of the map nodes and the dmn -> pdmnState
+ * pointers. It is immutable and built at most once per list version, see
+ * CDeterministicMNList::GetScan.
+ */
+class CDeterministicMNListScan
+{
+public:
+    enum Flags : uint8_t {
+        VALID = 1 << 0,
+        CONFIRMED = 1 << 1,
+    };
+
+    std::vector<uint256> proTxHashes;
+    std::vector<uint8_t> flags;
+    std::vector<uint256> confirmedHashesWithProRegTxHash;
+    // the full entries, for callers that need more than the fields above
+    std::vector<CDeterministicMNCPtr> dmns;
+
+public:
+    explicit CDeterministicMNListScan(const CDeterministicMNList& mnList);
+
+    size_t size() const { return dmns.size(); }
+};
+typedef std::shared_ptr<const CDeterministicMNListScan> CDeterministicMNListScanCPtr;
+
 template <typename Stream, typename K, typename T, typename Hash, typename Equal>
 void SerializeImmerMap(Stream& os, const immer::map<K, T, Hash, Equal>& m)
 {
@@ -276,6 +305,9 @@ public:
     typedef immer::map<uint256, CDeterministicMNCPtr> MnMap;
     typedef immer::map<uint64_t, uint256> MnInternalIdMap;
     typedef immer::map<uint256, std::pair<uint256, uint32_t> > MnUniquePropertyMap;
+    // (last paid, revived or registered height, proTxHash), the order in which valid MNs get paid
+    typedef std::pair<int, uint256> MnPaymentKey;
+    typedef immer::flex_vector<MnPaymentKey> MnPaymentOrder;
 
 private:
     uint256 blockHash;
@@ -288,6 +320,17 @@ private:
     // we keep track of this as checking for duplicates would otherwise be painfully slow
     MnUniquePropertyMap mnUniquePropertyMap;
 
+    // valid MNs in payment order, kept in sync with mnMap so that payee selection doesn't need to scan the list
+    MnPaymentOrder mnPaymentOrder;
+
+    // scan view of this list version. Copies of the list share the slot, so the view is built once
+    // for all of them. Every modification moves the list to a fresh slot
+    struct ScanSlot {
+        Mutex cs;
+        CDeterministicMNListScanCPtr scan GUARDED_BY(cs);
+    };
+    std::shared_ptr<ScanSlot> scanSlot{std::make_shared<ScanSlot>()};
+
 public:
     CDeterministicMNList() {}
     explicit CDeterministicMNList(const uint256& _blockHash, int _height, uint32_t _totalRegisteredCount) :
@@ -321,6 +364,8 @@ public:
         mnMap = MnMap();
         mnUniquePropertyMap = MnUniquePropertyMap();
         mnInternalIdMap = MnInternalIdMap();
+        mnPaymentOrder = MnPaymentOrder();
+        ResetScan();
 
         SerializationOpBase(s, CSerActionUnserialize());
 
@@ -338,15 +383,16 @@ public:
 
     size_t GetValidMNsCount() const
     {
-        size_t count = 0;
-        for (const auto& p : mnMap) {
-            if (IsMNValid(p.second)) {
-                count++;
-            }
-        }
-        return count;
+        return mnPaymentOrder.size();
     }
 
+    /**
+     * Returns the scan view of this list, building it on first use. Prefer it over ForEachMN for
+     * repeated whole-list passes over lists that are kept around, e.g. the ones returned by
+     * CDeterministicMNManager::GetListForBlock.
+     */
+    CDeterministicMNListScanCPtr GetScan() const;
+
     template <typename Callback>
     void ForEachMN(bool onlyValid, Callback&& cb) const
     {
@@ -490,6 +536,10 @@ public:
     }
 
 private:
+    void ResetScan();
+    void AddToPaymentOrder(const CDeterministicMNCPtr& dmn);
+    void RemoveFromPaymentOrder(const CDeterministicMNCPtr& dmn);
+
     template <typename T>
     void AddUniqueProperty(const CDeterministicMNCPtr& dmn, const T& v)
     {
@@ -637,6 +687,16 @@ private:
     std::map<uint256, CDeterministicMNList> mnListsCache;
     const CBlockIndex* tipIndex{nullptr};
 
+    // the result of the last successful BuildNewListFromBlock call. Connecting a block builds the same list twice,
+    // first to check the CbTx merkle root and then in ProcessBlock, so the second call reuses it
+    struct {
+        uint256 merkleRoot;
+        size_t txCount{0};
+        bool fZeroNonce{false};
+        uint256 prevBlockHash;
+        CDeterministicMNList mnList;
+    } lastBuiltList;
+
 public:
     CDeterministicMNManager(CEvoDB& _evoDb);
 
@@ -646,6 +706,7 @@ public:
     void UpdatedBlockTip(const CBlockIndex* pindex);
 
     // the returned list will not contain the correct block hash (we can't know it yet as the coinbase TX is not updated yet)
+    // calling this again for the same transactions and pindexPrev returns the same list without rebuilding it
     bool BuildNewListFromBlock(const CBlock& block, const CBlockIndex* pindexPrev, CValidationState& state, CDeterministicMNList& mnListRet, bool debugLogs);
     void HandleQuorumCommitment(llmq::CFinalCommitment& qc, const CBlockIndex* pindexQuorum, CDeterministicMNList& mnList, bool debugLogs);
     void DecreasePoSePenalties(CDeterministicMNList& mnList);
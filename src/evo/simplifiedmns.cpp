@@ -15,7 +15,13 @@
 #include "base58.h"
 #include "chainparams.h"
 #include "consensus/merkle.h"
+#include "crypto/sha256.h"
+#include "hash.h"
+#include "saltedhasher.h"
+#include "streams.h"
+#include "sync.h"
 #include "univalue.h"
+#include "unordered_lru_cache.h"
 #include "validation.h"
 
 CSimplifiedMNListEntry::CSimplifiedMNListEntry(const CDeterministicMN& dmn) :
@@ -67,16 +73,12 @@ CSimplifiedMNList::CSimplifiedMNList(const std::vector<CSimplifiedMNListEntry>&
 
 CSimplifiedMNList::CSimplifiedMNList(const CDeterministicMNList& dmnList)
 {
-    mnList.resize(dmnList.GetAllMNsCount());
-
-    size_t i = 0;
-    dmnList.ForEachMN(false, [this, &i](const CDeterministicMNCPtr& dmn) {
-        mnList[i++] = std::make_unique<CSimplifiedMNListEntry>(*dmn);
-    });
-
-    std::sort(mnList.begin(), mnList.end(), [&](const std::unique_ptr<CSimplifiedMNListEntry>& a, const std::unique_ptr<CSimplifiedMNListEntry>& b) {
-        return a->proRegTxHash.Compare(b->proRegTxHash) < 0;
-    });
+    // the scan view is already sorted by proTxHash
+    auto scan = dmnList.GetScan();
+    mnList.resize(scan->size());
+    for (size_t i = 0; i < scan->size(); i++) {
+        mnList[i] = std::make_unique<CSimplifiedMNListEntry>(*scan->dmns[i]);
+    }
 }
 
 uint256 CSimplifiedMNList::CalcMerkleRoot(bool* pmutated) const
@@ -89,6 +91,127 @@ uint256 CSimplifiedMNList::CalcMerkleRoot(bool* pmutated) const
     return ComputeMerkleRoot(leaves, pmutated);
 }
 
+void CSimplifiedMNListMerkleTree::Build(const CDeterministicMNList& dmnList)
+{
+    // the scan view is already sorted by proTxHash
+    auto scan = dmnList.GetScan();
+    proTxHashes = scan->proTxHashes;
+    levels.assign(1, std::vector<uint256>());
+    levels[0].reserve(scan->size());
+    for (const auto& dmn : scan->dmns) {
+        levels[0].emplace_back(CSimplifiedMNListEntry(*dmn).CalcHash());
+    }
+    BuildInnerLevels();
+}
+
+void CSimplifiedMNListMerkleTree::ApplyDiff(const CDeterministicMNList& from, const CDeterministicMNList& to, const CDeterministicMNListDiff& diff)
+{
+    // only these fields end up in a CSimplifiedMNListEntry
+    static const uint32_t smlFields = CDeterministicMNStateDiff::Field_confirmedHash |
+                                      CDeterministicMNStateDiff::Field_addr |
+                                      CDeterministicMNStateDiff::Field_pubKeyOperator |
+                                      CDeterministicMNStateDiff::Field_keyIDVoting |
+                                      CDeterministicMNStateDiff::Field_nPoSeBanHeight;
+
+    auto cmp = [](const uint256& a, const uint256& b) { return a.Compare(b) < 0; };
+    bool structureChanged = false;
+
+    for (const auto& internalId : diff.removedMns) {
+        auto dmn = from.GetMNByInternalId(internalId);
+        size_t pos = FindLeaf(dmn->proTxHash);
+        proTxHashes.erase(proTxHashes.begin() + pos);
+        levels[0].erase(levels[0].begin() + pos);
+        structureChanged = true;
+    }
+    for (const auto& dmn : diff.addedMNs) {
+        auto it = std::lower_bound(proTxHashes.begin(), proTxHashes.end(), dmn->proTxHash, cmp);
+        size_t pos = it - proTxHashes.begin();
+        proTxHashes.insert(it, dmn->proTxHash);
+        levels[0].insert(levels[0].begin() + pos, CSimplifiedMNListEntry(*dmn).CalcHash());
+        structureChanged = true;
+    }
+
+    std::vector<std::pair<size_t, uint256>> updatedLeaves;
+    for (const auto& p : diff.updatedMNs) {
+        if (!(p.second.fields & smlFields)) {
+            continue;
+        }
+        auto dmn = to.GetMNByInternalId(p.first);
+        updatedLeaves.emplace_back(FindLeaf(dmn->proTxHash), CSimplifiedMNListEntry(*dmn).CalcHash());
+    }
+
+    if (structureChanged) {
+        for (const auto& p : updatedLeaves) {
+            levels[0][p.first] = p.second;
+        }
+        BuildInnerLevels();
+    } else {
+        for (const auto& p : updatedLeaves) {
+            UpdatePath(p.first, p.second);
+        }
+    }
+}
+
+uint256 CSimplifiedMNListMerkleTree::GetMerkleRoot(bool* pmutated) const
+{
+    if (pmutated) {
+        *pmutated = nEqualPairs != 0;
+    }
+    if (levels.back().empty()) {
+        return uint256();
+    }
+    return levels.back()[0];
+}
+
+size_t CSimplifiedMNListMerkleTree::FindLeaf(const uint256& proTxHash) const
+{
+    auto it = std::lower_bound(proTxHashes.begin(), proTxHashes.end(), proTxHash, [](const uint256& a, const uint256& b) {
+        return a.Compare(b) < 0;
+    });
+    assert(it != proTxHashes.end() && *it == proTxHash);
+    return it - proTxHashes.begin();
+}
+
+void CSimplifiedMNListMerkleTree::BuildInnerLevels()
+{
+    levels.resize(1);
+    nEqualPairs = 0;
+    while (levels.back().size() > 1) {
+        const std::vector<uint256>& nodes = levels.back();
+        std::vector<uint256> parents((nodes.size() + 1) / 2);
+        for (size_t pos = 0; pos + 1 < nodes.size(); pos += 2) {
+            if (nodes[pos] == nodes[pos + 1]) nEqualPairs++;
+        }
+        // hash all complete pairs at once, the odd node at the end is paired with itself
+        SHA256D64(parents[0].begin(), nodes[0].begin(), nodes.size() / 2);
+        if (nodes.size() & 1) {
+            parents.back() = Hash(nodes.back().begin(), nodes.back().end(), nodes.back().begin(), nodes.back().end());
+        }
+        levels.emplace_back(std::move(parents));
+    }
+}
+
+void CSimplifiedMNListMerkleTree::UpdatePath(size_t pos, const uint256& leafHash)
+{
+    uint256 hash = leafHash;
+    for (auto& nodes : levels) {
+        if (nodes.size() == 1) {
+            nodes[0] = hash;
+            break;
+        }
+        size_t sibling = pos ^ 1;
+        bool hasSibling = sibling < nodes.size();
+        if (hasSibling && nodes[pos] == nodes[sibling]) nEqualPairs--;
+        nodes[pos] = hash;
+        if (hasSibling && nodes[pos] == nodes[sibling]) nEqualPairs++;
+
+        const uint256& left = nodes[pos & ~(size_t)1];
+        const uint256& right = hasSibling ? nodes[pos | 1] : left;
+        hash = Hash(left.begin(), left.end(), right.begin(), right.end());
+        pos >>= 1;
+    }
+}
+
 CSimplifiedMNListDiff::CSimplifiedMNListDiff()
 {
 }
@@ -186,10 +309,9 @@ void CSimplifiedMNListDiff::ToJson(UniValue& obj) const
     }
 }
 
-bool BuildSimplifiedMNListDiff(const uint256& baseBlockHash, const uint256& blockHash, CSimplifiedMNListDiff& mnListDiffRet, std::string& errorRet)
+static bool LookupSimplifiedMNListDiffBlocks(const uint256& baseBlockHash, const uint256& blockHash, const CBlockIndex*& baseBlockIndexRet, const CBlockIndex*& blockIndexRet, std::string& errorRet)
 {
     AssertLockHeld(cs_main);
-    mnListDiffRet = CSimplifiedMNListDiff();
 
     const CBlockIndex* baseBlockIndex = ::ChainActive().Genesis();
     if (!baseBlockHash.IsNull()) {
@@ -216,6 +338,22 @@ bool BuildSimplifiedMNListDiff(const uint256& baseBlockHash, const uint256& bloc
         return false;
     }
 
+    baseBlockIndexRet = baseBlockIndex;
+    blockIndexRet = blockIndex;
+    return true;
+}
+
+bool BuildSimplifiedMNListDiff(const uint256& baseBlockHash, const uint256& blockHash, CSimplifiedMNListDiff& mnListDiffRet, std::string& errorRet)
+{
+    AssertLockHeld(cs_main);
+    mnListDiffRet = CSimplifiedMNListDiff();
+
+    const CBlockIndex* baseBlockIndex;
+    const CBlockIndex* blockIndex;
+    if (!LookupSimplifiedMNListDiffBlocks(baseBlockHash, blockHash, baseBlockIndex, blockIndex, errorRet)) {
+        return false;
+    }
+
     LOCK(deterministicMNManager->cs);
 
     auto baseDmnList = deterministicMNManager->GetListForBlock(baseBlockIndex);
@@ -253,3 +391,52 @@ bool BuildSimplifiedMNListDiff(const uint256& baseBlockHash, const uint256& bloc
 
     return true;
 }
+
+// The diff between two blocks of the active chain never changes, so entries only need to be evicted for space.
+// Keys are the hash of both requested block hashes and the serialization version.
+static CCriticalSection cs_mnListDiffCache;
+static unordered_lru_cache<std::pair<uint256, int>, std::shared_ptr<const std::vector<unsigned char>>, StaticSaltedHasher, 64> mnListDiffCache GUARDED_BY(cs_mnListDiffCache);
+
+bool GetSerializedSimplifiedMNListDiff(const uint256& baseBlockHash, const uint256& blockHash, int nVersion, std::shared_ptr<const std::vector<unsigned char>>& dataRet, std::string& errorRet)
+{
+    AssertLockHeld(cs_main);
+
+    // validate the request even if the diff is cached, as the blocks might not be in the active chain anymore
+    const CBlockIndex* baseBlockIndex;
+    const CBlockIndex* blockIndex;
+    if (!LookupSimplifiedMNListDiffBlocks(baseBlockHash, blockHash, baseBlockIndex, blockIndex, errorRet)) {
+        return false;
+    }
+
+    auto key = std::make_pair(Hash(baseBlockHash.begin(), baseBlockHash.end(), blockHash.begin(), blockHash.end()), nVersion);
+    {
+        LOCK(cs_mnListDiffCache);
+        if (mnListDiffCache.get(key, dataRet)) {
+            return true;
+        }
+    }
+
+    CSimplifiedMNListDiff mnListDiff;
+    if (!BuildSimplifiedMNListDiff(baseBlockHash, blockHash, mnListDiff, errorRet)) {
+        return false;
+    }
+
+    auto data = std::make_shared<std::vector<unsigned char>>();
+    CVectorWriter(SER_NETWORK, nVersion, *data, 0, mnListDiff);
+    dataRet = data;
+
+    LOCK(cs_mnListDiffCache);
+    mnListDiffCache.insert(key, dataRet);
+    return true;
+}
+
+void CacheSimplifiedMNListDiffForTip(const CBlockIndex* pindexNew)
+{
+    // Light clients start from the full list at the tip, which is the most expensive diff to build
+    LOCK(cs_main);
+    std::shared_ptr<const std::vector<unsigned char>> data;
+    std::string strError;
+    if (!GetSerializedSimplifiedMNListDiff(uint256(), pindexNew->GetBlockHash(), PROTOCOL_VERSION, data, strError)) {
+        LogPrint(BCLog::MASTERNODE, "%s -- failed to build mnlistdiff for block %s: %s\n", __func__, pindexNew->GetBlockHash().ToString(), strError);
+    }
+}
@@ -13,7 +13,9 @@
 #include "version.h"
 
 class UniValue;
+class CBlockIndex;
 class CDeterministicMNList;
+class CDeterministicMNListDiff;
 class CDeterministicMN;
 
 namespace llmq
@@ -84,6 +86,39 @@ public:
     uint256 CalcMerkleRoot(bool* pmutated = NULL) const;
 };
 
+/**
+ * Merkle tree over the entries of a simplified MN list, with the same root as
+ * CSimplifiedMNList::CalcMerkleRoot. All levels of the tree are kept, so applying a
+ * CDeterministicMNListDiff only hashes the changed entries and the nodes above them.
+ * Added or removed entries shift the following leaves, which requires the inner nodes
+ * to be rebuilt, but the leaf hashes of unchanged entries are always reused.
+ */
+class CSimplifiedMNListMerkleTree
+{
+private:
+    // proRegTxHash of every leaf, sorted
+    std::vector<uint256> proTxHashes;
+    // levels[0] are the leaf hashes, levels.back() holds the root
+    std::vector<std::vector<uint256>> levels;
+    // Number of pairs of equal sibling nodes, see ComputeMerkleRoot
+    size_t nEqualPairs{0};
+
+public:
+    CSimplifiedMNListMerkleTree() : levels(1) {}
+
+    void Build(const CDeterministicMNList& dmnList);
+    // diff must have been built with from.BuildDiff(to), where from is the list this tree represents
+    void ApplyDiff(const CDeterministicMNList& from, const CDeterministicMNList& to, const CDeterministicMNListDiff& diff);
+
+    uint256 GetMerkleRoot(bool* pmutated = nullptr) const;
+    size_t GetLeafCount() const { return proTxHashes.size(); }
+
+private:
+    size_t FindLeaf(const uint256& proTxHash) const;
+    void BuildInnerLevels();
+    void UpdatePath(size_t pos, const uint256& leafHash);
+};
+
 /// P2P messages
 
 class CGetSimplifiedMNListDiff
@@ -146,5 +181,9 @@ public:
 };
 
 bool BuildSimplifiedMNListDiff(const uint256& baseBlockHash, const uint256& blockHash, CSimplifiedMNListDiff& mnListDiffRet, std::string& errorRet);
+// Same as BuildSimplifiedMNListDiff, but returns the diff serialized for nVersion, from an LRU cache when possible
+bool GetSerializedSimplifiedMNListDiff(const uint256& baseBlockHash, const uint256& blockHash, int nVersion, std::shared_ptr<const std::vector<unsigned char>>& dataRet, std::string& errorRet);
+// Build and cache the diff from the genesis block to a new tip, which is what light clients request first
+void CacheSimplifiedMNListDiffForTip(const CBlockIndex* pindexNew);
 
 #endif //DASH_SIMPLIFIEDMNS_H
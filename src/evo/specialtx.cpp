@@ -88,11 +88,9 @@ bool UndoSpecialTx(const CTransaction& tx, const CBlockIndex* pindex)
     return false;
 }
 
-bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CValidationState& state, bool fJustCheck, bool fCheckCbTxMerleRoots)
+bool CheckSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CValidationState& state, bool fCheckCbTxMerleRoots)
 {
-    static int64_t nTimeLoop = 0;
-    static int64_t nTimeQuorum = 0;
-    static int64_t nTimeDMN = 0;
+    static int64_t nTimeCheck = 0;
     static int64_t nTimeMerkle = 0;
 
     int64_t nTime1 = GetTimeMicros();
@@ -102,6 +100,31 @@ bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CV
         if (!CheckSpecialTx(tx, pindex->pprev, state)) {
             return false;
         }
+    }
+
+    int64_t nTime2 = GetTimeMicros(); nTimeCheck += nTime2 - nTime1;
+    LogPrint(BCLog::BNCH, "        - CheckSpecialTx: %.2fms [%.2fs]\n", 0.001 * (nTime2 - nTime1), nTimeCheck * 0.000001);
+
+    if (fCheckCbTxMerleRoots && !CheckCbTxMerkleRoots(block, pindex, state)) {
+        return false;
+    }
+
+    int64_t nTime3 = GetTimeMicros(); nTimeMerkle += nTime3 - nTime2;
+    LogPrint(BCLog::BNCH, "        - CheckCbTxMerkleRoots: %.2fms [%.2fs]\n", 0.001 * (nTime3 - nTime2), nTimeMerkle * 0.000001);
+
+    return true;
+}
+
+bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CValidationState& state, bool fJustCheck)
+{
+    static int64_t nTimeLoop = 0;
+    static int64_t nTimeQuorum = 0;
+    static int64_t nTimeDMN = 0;
+
+    int64_t nTime1 = GetTimeMicros();
+
+    for (int i = 0; i < (int)block.vtx.size(); i++) {
+        const CTransaction& tx = *block.vtx[i];
         if (!ProcessSpecialTx(tx, pindex, state)) {
             return false;
         }
@@ -124,13 +147,6 @@ bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CV
     int64_t nTime4 = GetTimeMicros(); nTimeDMN += nTime4 - nTime3;
     LogPrint(BCLog::BNCH, "        - deterministicMNManager: %.2fms [%.2fs]\n", 0.001 * (nTime4 - nTime3), nTimeDMN * 0.000001);
 
-    if (fCheckCbTxMerleRoots && !CheckCbTxMerkleRoots(block, pindex, state)) {
-        return false;
-    }
-
-    int64_t nTime5 = GetTimeMicros(); nTimeMerkle += nTime5 - nTime4;
-    LogPrint(BCLog::BNCH, "        - CheckCbTxMerkleRoots: %.2fms [%.2fs]\n", 0.001 * (nTime5 - nTime4), nTimeMerkle * 0.000001);
-
     return true;
 }
 
@@ -14,7 +14,10 @@ class CBlockIndex;
 class CValidationState;
 
 bool CheckSpecialTx(const CTransaction& tx, const CBlockIndex* pindexPrev, CValidationState& state);
-bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CValidationState& state, bool fJustCheck, bool fCheckCbTxMerleRoots);
+// Checks only depend on the block and on the state at pindex->pprev, so they can run before the block's scripts are verified
+bool CheckSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CValidationState& state, bool fCheckCbTxMerleRoots);
+// Must only be called for blocks that passed CheckSpecialTxsInBlock
+bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CValidationState& state, bool fJustCheck);
 bool UndoSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex);
 
 template <typename T>
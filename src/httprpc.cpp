@@ -18,6 +18,7 @@
 #include <walletinitinterface.h>
 
 #include <memory>
+#include <set>
 #include <stdio.h>
 
 #include <boost/algorithm/string.hpp> // boost::trim
@@ -25,6 +26,28 @@
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/** Replies larger than this are sent in chunks of about this size while being serialized */
+static const size_t JSONRPC_REPLY_CHUNK_SIZE = 256 * 1024;
+
+/** Calls to these methods only read cached state, so they are queued ahead of other requests */
+static const std::set<std::string> HIGH_PRIORITY_RPC_METHODS{
+    "getbestblockhash",
+    "getbestchainlock",
+    "getblockcount",
+    "getblockhash",
+    "getblockheader",
+    "getconnectioncount",
+    "getdifficulty",
+    "getmempoolinfo",
+    "getnetworkinfo",
+    "uptime",
+};
+
+/** Requests to high priority methods are small, so the method name is looked for only in the
+ * start of the body.
+ */
+static const size_t JSONRPC_CLASSIFY_PEEK_SIZE = 1024;
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -84,6 +107,32 @@ static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const Uni
     req->WriteReply(nStatus, strReply);
 }
 
+static void JSONRPCWriteReply(HTTPRequest* req, const UniValue& result, const UniValue& id)
+{
+    // Hold back the first chunk: if it is the only one, the reply is sent in one piece as usual.
+    // Otherwise the reply is streamed, so large results are never held as one string.
+    std::string strFirstChunk;
+    bool fStarted = false;
+    JSONRPCReplyChunked(result, id, JSONRPC_REPLY_CHUNK_SIZE, [&](std::string&& strChunk) {
+        if (!fStarted && strFirstChunk.empty()) {
+            strFirstChunk = std::move(strChunk);
+            return;
+        }
+        if (!fStarted) {
+            req->WriteReplyStart(HTTP_OK);
+            req->WriteReplyChunk(std::move(strFirstChunk));
+            fStarted = true;
+        }
+        req->WriteReplyChunk(std::move(strChunk));
+    });
+
+    if (fStarted) {
+        req->WriteReplyEnd();
+    } else {
+        req->WriteReply(HTTP_OK, strFirstChunk);
+    }
+}
+
 //This function checks username and password against -rpcauth
 //entries from config file.
 static bool multiUserAuthorized(std::string strUserPass)
@@ -184,7 +233,6 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         // Set the URI
         jreq.URI = req->GetURI();
 
-        std::string strReply;
         // singleton request
         if (valRequest.isObject()) {
             jreq.parse(valRequest);
@@ -192,16 +240,16 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
             UniValue result = tableRPC.execute(jreq);
 
             // Send reply
-            strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            req->WriteHeader("Content-Type", "application/json");
+            JSONRPCWriteReply(req, result, jreq.id);
 
         // array of requests
-        } else if (valRequest.isArray())
-            strReply = JSONRPCExecBatch(jreq, valRequest.get_array());
-        else
+        } else if (valRequest.isArray()) {
+            std::string strReply = JSONRPCExecBatch(jreq, valRequest.get_array());
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, strReply);
+        } else
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
-
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strReply);
     } catch (const UniValue& objError) {
         JSONErrorReply(req, objError, jreq.id);
         return false;
@@ -234,15 +282,51 @@ static bool InitRPCAuthentication()
     return true;
 }
 
+/** Pick the work queue lane of a JSON-RPC request from its method name, without parsing the body.
+ * Only single requests whose first "method" key names a high priority method get the high
+ * priority lane. A misread body only affects queueing order: the request is still parsed and
+ * authorized by HTTPReq_JSONRPC.
+ */
+static HTTPPriority ClassifyJSONRPCRequest(HTTPRequest* req, const std::string &)
+{
+    if (req->GetRequestMethod() != HTTPRequest::POST) {
+        return HTTPPriority::NORMAL;
+    }
+    const std::string body = req->PeekBody(JSONRPC_CLASSIFY_PEEK_SIZE);
+    const char* const ws = " \t\r\n";
+    size_t pos = body.find_first_not_of(ws);
+    if (pos == std::string::npos || body[pos] != '{') {
+        return HTTPPriority::NORMAL;
+    }
+    pos = body.find("\"method\"", pos);
+    if (pos == std::string::npos) {
+        return HTTPPriority::NORMAL;
+    }
+    pos = body.find_first_not_of(ws, pos + 8);
+    if (pos == std::string::npos || body[pos] != ':') {
+        return HTTPPriority::NORMAL;
+    }
+    pos = body.find_first_not_of(ws, pos + 1);
+    if (pos == std::string::npos || body[pos] != '"') {
+        return HTTPPriority::NORMAL;
+    }
+    const size_t end = body.find('"', pos + 1);
+    if (end == std::string::npos) {
+        return HTTPPriority::NORMAL;
+    }
+    const std::string method = body.substr(pos + 1, end - pos - 1);
+    return HIGH_PRIORITY_RPC_METHODS.count(method) ? HTTPPriority::HIGH : HTTPPriority::NORMAL;
+}
+
 bool StartHTTPRPC()
 {
     LogPrint(BCLog::RPC, "Starting HTTP RPC server\n");
     if (!InitRPCAuthentication())
         return false;
 
-    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC);
+    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC, ClassifyJSONRPCRequest);
     if (g_wallet_init_interface.HasWalletSupport()) {
-        RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC);
+        RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC, ClassifyJSONRPCRequest);
     }
     struct event_base* eventBase = EventBase();
     assert(eventBase);
@@ -64,7 +64,10 @@ private:
 };
 
 /** Simple work queue for distributing work over multiple threads.
- * Work items are simply callable objects.
+ * Work items are simply callable objects. Items are queued in one of two
+ * lanes: high priority items are always taken first, and at most
+ * maxNormalActive threads run normal priority items at once, so that slow
+ * requests cannot hold up every thread.
  */
 template <typename WorkItem>
 class WorkQueue
@@ -74,12 +77,17 @@ private:
     Mutex cs;
     std::condition_variable cond;
     std::deque<std::unique_ptr<WorkItem>> queue;
+    std::deque<std::unique_ptr<WorkItem>> queuePriority;
     bool running;
     size_t maxDepth;
+    size_t maxNormalActive;
+    size_t normalActive;
 
 public:
-    explicit WorkQueue(size_t _maxDepth) : running(true),
-                                 maxDepth(_maxDepth)
+    WorkQueue(size_t _maxDepth, size_t _maxNormalActive) : running(true),
+                                 maxDepth(_maxDepth),
+                                 maxNormalActive(_maxNormalActive),
+                                 normalActive(0)
     {
     }
     /** Precondition: worker threads have all stopped (they have been joined).
@@ -87,15 +95,17 @@ public:
     ~WorkQueue()
     {
     }
-    /** Enqueue a work item */
-    bool Enqueue(WorkItem* item)
+    /** Enqueue a work item. Each lane holds up to maxDepth items. */
+    bool Enqueue(WorkItem* item, HTTPPriority priority)
     {
         LOCK(cs);
-        if (queue.size() >= maxDepth) {
+        auto& lane = priority == HTTPPriority::HIGH ? queuePriority : queue;
+        if (lane.size() >= maxDepth) {
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
-        cond.notify_one();
+        lane.emplace_back(std::unique_ptr<WorkItem>(item));
+        // Wake all: a waiting thread may be unable to take a normal priority item
+        cond.notify_all();
         return true;
     }
     /** Thread function */
@@ -103,16 +113,25 @@ public:
     {
         while (true) {
             std::unique_ptr<WorkItem> i;
+            bool normal;
             {
                 WAIT_LOCK(cs, lock);
-                while (running && queue.empty())
+                while (running && queuePriority.empty() && (queue.empty() || normalActive >= maxNormalActive))
                     cond.wait(lock);
                 if (!running)
                     break;
-                i = std::move(queue.front());
-                queue.pop_front();
+                normal = queuePriority.empty();
+                auto& lane = normal ? queue : queuePriority;
+                i = std::move(lane.front());
+                lane.pop_front();
+                if (normal) ++normalActive;
             }
             (*i)();
+            if (normal) {
+                LOCK(cs);
+                --normalActive;
+                if (!queue.empty()) cond.notify_one();
+            }
         }
     }
     /** Interrupt and exit loops */
@@ -126,13 +145,14 @@ public:
 
 struct HTTPPathHandler
 {
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPRequestClassifier _classifier):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), classifier(_classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPRequestClassifier classifier;
 };
 
 /** HTTP module state */
@@ -263,9 +283,10 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
+        const HTTPPriority priority = i->classifier ? i->classifier(hreq.get(), path) : HTTPPriority::NORMAL;
         std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
         assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        if (workQueue->Enqueue(item.get(), priority))
             item.release(); /* if true, queue took ownership */
         else {
             LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
@@ -394,7 +415,9 @@ bool InitHTTPServer()
     int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
     LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    // Keep one worker thread free for high priority requests, if there is more than one
+    int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
+    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth, std::max(rpcThreads - 1, 1));
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -506,12 +529,17 @@ void HTTPEvent::trigger(struct timeval* tv)
         evtimer_add(ev, tv); // trigger after timeval passed
 }
 HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req),
-                                                       replySent(false)
+                                                       replySent(false),
+                                                       replyStarted(false)
 {
 }
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (replyStarted && !replySent) {
+        // The status was sent already, all we can do is to finish the reply
+        LogPrintf("%s: Unfinished reply\n", __func__);
+        WriteReplyEnd();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL, "Unhandled request");
@@ -550,6 +578,17 @@ std::string HTTPRequest::ReadBody()
     return rv;
 }
 
+std::string HTTPRequest::PeekBody(size_t max_size) const
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    std::string rv(std::min(evbuffer_get_length(buf), max_size), '\0');
+    ev_ssize_t copied = evbuffer_copyout(buf, &rv[0], rv.size());
+    rv.resize(std::max<ev_ssize_t>(copied, 0));
+    return rv;
+}
+
 void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 {
     struct evkeyvalq* headers = evhttp_request_get_output_headers(req);
@@ -564,7 +603,7 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
  */
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
 {
-    assert(!replySent && req);
+    assert(!replySent && !replyStarted && req);
     if (ShutdownRequested()) {
         WriteHeader("Connection", "close");
     }
@@ -592,6 +631,64 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     req = nullptr; // transferred back to main thread
 }
 
+void HTTPRequest::WriteReplyStart(int nStatus)
+{
+    assert(!replySent && !replyStarted && req);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    // Headers are sent by the main http thread, so they must not be written after this
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+    replyStarted = true;
+}
+
+void HTTPRequest::WriteReplyChunk(std::string&& strChunk)
+{
+    assert(replyStarted && !replySent && req);
+    if (strChunk.empty()) {
+        // An empty chunk would terminate a chunked reply
+        return;
+    }
+    // Events are run in the order they are triggered, so chunks are sent in order
+    auto req_copy = req;
+    auto chunk = std::make_shared<std::string>(std::move(strChunk));
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, chunk]{
+        struct evbuffer* evb = evbuffer_new();
+        if (evb) {
+            evbuffer_add(evb, chunk->data(), chunk->size());
+            evhttp_send_reply_chunk(req_copy, evb);
+            evbuffer_free(evb);
+        }
+    });
+    ev->trigger(nullptr);
+}
+
+void HTTPRequest::WriteReplyEnd()
+{
+    assert(replyStarted && !replySent && req);
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy]{
+        evhttp_send_reply_end(req_copy);
+        // Re-enable reading from the socket, see WriteReply
+        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+            if (conn) {
+                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+                if (bev) {
+                    bufferevent_enable(bev, EV_READ | EV_WRITE);
+                }
+            }
+        }
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
 CService HTTPRequest::GetPeer() const
 {
     evhttp_connection* con = evhttp_request_get_connection(req);
@@ -632,10 +729,11 @@ HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod() const
     }
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler,
+                         const HTTPRequestClassifier &classifier)
 {
     LogPrint(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
-    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler));
+    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler, classifier));
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
@@ -38,11 +38,20 @@ bool UpdateHTTPServerLogging(bool enable);
 
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Work queue lane of a request. High priority requests are taken by the worker
+ * threads first, and one worker thread is kept free for them.
+ */
+enum class HTTPPriority { NORMAL, HIGH };
+/** Picks the lane of a request. Called on the event loop thread, so it must be cheap
+ * and must not consume the request body.
+ */
+typedef std::function<HTTPPriority(HTTPRequest* req, const std::string &)> HTTPRequestClassifier;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
- * be invoked.
+ * be invoked. Without a classifier, requests go to the normal priority lane.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler,
+                         const HTTPRequestClassifier &classifier = nullptr);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
@@ -59,6 +68,7 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    bool replyStarted;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req);
@@ -98,6 +108,11 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * Return up to max_size bytes from the start of the request body, without consuming it.
+     */
+    std::string PeekBody(size_t max_size) const;
+
     /**
      * Write output header.
      *
@@ -114,6 +129,19 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Write HTTP reply in pieces, for large replies that are produced incrementally.
+     * WriteReplyStart sends the status and headers, each WriteReplyChunk sends a part of
+     * the body (with chunked transfer encoding for HTTP/1.1 clients) and WriteReplyEnd
+     * completes the reply.
+     *
+     * @note As with WriteReply, do not call any other HTTPRequest methods after
+     * calling WriteReplyEnd.
+     */
+    void WriteReplyStart(int nStatus);
+    void WriteReplyChunk(std::string&& strChunk);
+    void WriteReplyEnd();
 };
 
 /** Event handler closure.
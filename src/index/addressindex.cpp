@@ -0,0 +1,355 @@
+// Copyright (c) 2019-2020 Zentoshi LLC
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <hash.h>
+#include <index/addressindex.h>
+#include <pubkey.h>
+#include <script/standard.h>
+#include <undo.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <map>
+
+/* The index database stores three kinds of entries per script, all keyed by the HASH160 of the
+ * scriptPubKey:
+ *
+ * - [DB_ADDRESS_DELTA, script hash, height (BE), tx position (BE), txid, index (BE), spending]
+ *   -> amount (negative for spends). Big-endian integers keep the history of a script ordered by
+ *   height, so a range of heights is a single seek followed by sequential reads.
+ * - [DB_ADDRESS_UNSPENT, script hash, txid, index (BE)] -> amount and height of the output.
+ * - [DB_ADDRESS_BALANCE, script hash] -> current balance and total amount received.
+ */
+constexpr char DB_ADDRESS_DELTA = 'a';
+constexpr char DB_ADDRESS_UNSPENT = 'u';
+constexpr char DB_ADDRESS_BALANCE = 'b';
+
+std::unique_ptr<AddressIndex> g_addressindex;
+
+namespace {
+
+struct DBDeltaKey {
+    uint160 script_hash;
+    int height;
+    uint32_t tx_index;
+    uint256 txid;
+    uint32_t index;
+    bool spending;
+
+    DBDeltaKey() : height(0), tx_index(0), index(0), spending(false) {}
+    DBDeltaKey(const uint160& script_hash_in, int height_in, uint32_t tx_index_in,
+               const uint256& txid_in, uint32_t index_in, bool spending_in) :
+        script_hash(script_hash_in), height(height_in), tx_index(tx_index_in),
+        txid(txid_in), index(index_in), spending(spending_in) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_ADDRESS_DELTA);
+        script_hash.Serialize(s);
+        ser_writedata32be(s, height);
+        ser_writedata32be(s, tx_index);
+        txid.Serialize(s);
+        ser_writedata32be(s, index);
+        ser_writedata8(s, spending);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        char prefix = ser_readdata8(s);
+        if (prefix != DB_ADDRESS_DELTA) {
+            throw std::ios_base::failure("Invalid format for addressindex DB delta key");
+        }
+        script_hash.Unserialize(s);
+        height = ser_readdata32be(s);
+        tx_index = ser_readdata32be(s);
+        txid.Unserialize(s);
+        index = ser_readdata32be(s);
+        spending = ser_readdata8(s);
+    }
+};
+
+struct DBUnspentKey {
+    uint160 script_hash;
+    COutPoint outpoint;
+
+    DBUnspentKey() {}
+    DBUnspentKey(const uint160& script_hash_in, const COutPoint& outpoint_in) :
+        script_hash(script_hash_in), outpoint(outpoint_in) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_ADDRESS_UNSPENT);
+        script_hash.Serialize(s);
+        outpoint.hash.Serialize(s);
+        ser_writedata32be(s, outpoint.n);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        char prefix = ser_readdata8(s);
+        if (prefix != DB_ADDRESS_UNSPENT) {
+            throw std::ios_base::failure("Invalid format for addressindex DB unspent key");
+        }
+        script_hash.Unserialize(s);
+        outpoint.hash.Unserialize(s);
+        outpoint.n = ser_readdata32be(s);
+    }
+};
+
+struct DBUnspentValue {
+    CAmount amount;
+    int height;
+
+    DBUnspentValue() : amount(0), height(0) {}
+    DBUnspentValue(CAmount amount_in, int height_in) : amount(amount_in), height(height_in) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(amount);
+        READWRITE(height);
+    }
+};
+
+struct DBBalanceKey {
+    uint160 script_hash;
+
+    explicit DBBalanceKey(const uint160& script_hash_in) : script_hash(script_hash_in) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        char prefix = DB_ADDRESS_BALANCE;
+        READWRITE(prefix);
+        if (prefix != DB_ADDRESS_BALANCE) {
+            throw std::ios_base::failure("Invalid format for addressindex DB balance key");
+        }
+
+        READWRITE(script_hash);
+    }
+};
+
+}; // namespace
+
+/** Pay-to-pubkey outputs are keyed like pay-to-pubkey-hash outputs of the same key, so that they are found by
+ * the address of the key.
+ */
+static uint160 GetScriptHash(const CScript& script)
+{
+    std::vector<std::vector<unsigned char>> solutions;
+    if (Solver(script, solutions) == TX_PUBKEY) {
+        CPubKey pubkey(solutions[0]);
+        if (pubkey.IsValid()) {
+            return Hash160(GetScriptForDestination(PKHash(pubkey)));
+        }
+    }
+    return Hash160(script);
+}
+
+AddressIndex::AddressIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<BaseIndex::DB>(GetDataDir() / "indexes" / "addressindex", n_cache_size, f_memory, f_wipe))
+{}
+
+bool AddressIndex::ApplyBlock(CDBBatch& batch, const CBlock& block, const CBlockIndex* pindex, bool disconnect)
+{
+    // The genesis block outputs are not part of the UTXO set (see ConnectBlock)
+    if (pindex->nHeight == 0) {
+        return true;
+    }
+
+    CBlockUndo block_undo;
+    if (!UndoReadFromDisk(block_undo, pindex)) {
+        return error("%s: Failed to read undo data of block %s",
+                     __func__, pindex->GetBlockHash().ToString());
+    }
+
+    // Balance and received amount changes per script, applied with one read per script below
+    std::map<uint160, std::pair<CAmount, CAmount>> balance_changes;
+
+    const size_t tx_count = block.vtx.size();
+    for (size_t k = 0; k < tx_count; ++k) {
+        // When disconnecting, walk the block backwards so that outputs spent within the block are
+        // restored before they are removed again.
+        const size_t i = disconnect ? tx_count - 1 - k : k;
+        const CTransaction& tx = *block.vtx[i];
+        const uint256& txid = tx.GetHash();
+
+        if (disconnect) {
+            for (uint32_t j = 0; j < tx.vout.size(); ++j) {
+                const CTxOut& out = tx.vout[j];
+                if (out.scriptPubKey.empty() || out.scriptPubKey.IsUnspendable()) continue;
+
+                const uint160 script_hash = GetScriptHash(out.scriptPubKey);
+                batch.Erase(DBDeltaKey(script_hash, pindex->nHeight, i, txid, j, false));
+                batch.Erase(DBUnspentKey(script_hash, COutPoint(txid, j)));
+                auto& change = balance_changes[script_hash];
+                change.first -= out.nValue;
+                change.second -= out.nValue;
+            }
+        }
+
+        if (!tx.IsCoinBase()) {
+            const CTxUndo& tx_undo = block_undo.vtxundo.at(i - 1);
+            for (uint32_t j = 0; j < tx.vin.size(); ++j) {
+                const Coin& coin = tx_undo.vprevout[j];
+                if (coin.out.scriptPubKey.empty()) continue;
+
+                const uint160 script_hash = GetScriptHash(coin.out.scriptPubKey);
+                const COutPoint& prevout = tx.vin[j].prevout;
+                if (disconnect) {
+                    batch.Erase(DBDeltaKey(script_hash, pindex->nHeight, i, txid, j, true));
+                    batch.Write(DBUnspentKey(script_hash, prevout), DBUnspentValue(coin.out.nValue, coin.nHeight));
+                    balance_changes[script_hash].first += coin.out.nValue;
+                } else {
+                    batch.Write(DBDeltaKey(script_hash, pindex->nHeight, i, txid, j, true), -coin.out.nValue);
+                    batch.Erase(DBUnspentKey(script_hash, prevout));
+                    balance_changes[script_hash].first -= coin.out.nValue;
+                }
+            }
+        }
+
+        if (!disconnect) {
+            for (uint32_t j = 0; j < tx.vout.size(); ++j) {
+                const CTxOut& out = tx.vout[j];
+                if (out.scriptPubKey.empty() || out.scriptPubKey.IsUnspendable()) continue;
+
+                const uint160 script_hash = GetScriptHash(out.scriptPubKey);
+                batch.Write(DBDeltaKey(script_hash, pindex->nHeight, i, txid, j, false), out.nValue);
+                batch.Write(DBUnspentKey(script_hash, COutPoint(txid, j)), DBUnspentValue(out.nValue, pindex->nHeight));
+                auto& change = balance_changes[script_hash];
+                change.first += out.nValue;
+                change.second += out.nValue;
+            }
+        }
+    }
+
+    for (const auto& p : balance_changes) {
+        std::pair<CAmount, CAmount> balance{0, 0};
+        if (!m_db->Read(DBBalanceKey(p.first), balance) && m_db->Exists(DBBalanceKey(p.first))) {
+            return error("%s: unable to read balance entry of script %s", __func__, p.first.ToString());
+        }
+        balance.first += p.second.first;
+        balance.second += p.second.second;
+        if (balance.first == 0 && balance.second == 0) {
+            batch.Erase(DBBalanceKey(p.first));
+        } else {
+            batch.Write(DBBalanceKey(p.first), balance);
+        }
+    }
+
+    return true;
+}
+
+/** Balances are updated by read-modify-write, so the locator of the block they include goes into the same
+ * batch. Otherwise blocks after the last committed locator would be applied twice after an unclean shutdown.
+ */
+void AddressIndex::WriteLocator(CDBBatch& batch, const CBlockIndex* pindex)
+{
+    m_db->WriteBestBlock(batch, GetLocator(pindex));
+}
+
+bool AddressIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    CDBBatch batch(*m_db);
+    if (!ApplyBlock(batch, block, pindex, false)) {
+        return false;
+    }
+    WriteLocator(batch, pindex);
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    const auto& consensus_params = Params().GetConsensus();
+    for (const CBlockIndex* pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            return error("%s: Failed to read block %s from disk",
+                         __func__, pindex->GetBlockHash().ToString());
+        }
+        // Balances are read back from the database, so every block is written before the next, together with
+        // the locator of the block it rewinds to
+        CDBBatch batch(*m_db);
+        if (!ApplyBlock(batch, block, pindex, true)) {
+            return false;
+        }
+        WriteLocator(batch, pindex->pprev);
+        if (!m_db->WriteBatch(batch)) {
+            return false;
+        }
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+bool AddressIndex::GetBalance(const CScript& script, CAmount& balance, CAmount& received) const
+{
+    const DBBalanceKey key(GetScriptHash(script));
+    std::pair<CAmount, CAmount> value{0, 0};
+    if (!m_db->Read(key, value) && m_db->Exists(key)) {
+        return false;
+    }
+    balance = value.first;
+    received = value.second;
+    return true;
+}
+
+bool AddressIndex::GetDeltas(const CScript& script, int start_height, int end_height, std::vector<CAddressDelta>& deltas) const
+{
+    const uint160 script_hash = GetScriptHash(script);
+
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    db_it->Seek(DBDeltaKey(script_hash, std::max(start_height, 0), 0, uint256(), 0, false));
+
+    DBDeltaKey key;
+    for (; db_it->Valid(); db_it->Next()) {
+        if (!db_it->GetKey(key) || key.script_hash != script_hash) break;
+        if (end_height >= 0 && key.height > end_height) break;
+
+        CAddressDelta delta;
+        if (!db_it->GetValue(delta.amount)) {
+            return error("%s: unable to read value of delta %s:%d", __func__, key.txid.ToString(), key.index);
+        }
+        delta.height = key.height;
+        delta.tx_index = key.tx_index;
+        delta.txid = key.txid;
+        delta.index = key.index;
+        delta.spending = key.spending;
+        deltas.push_back(std::move(delta));
+    }
+    return true;
+}
+
+bool AddressIndex::GetUnspent(const CScript& script, std::vector<CAddressUnspent>& unspent) const
+{
+    const uint160 script_hash = GetScriptHash(script);
+
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    db_it->Seek(DBUnspentKey(script_hash, COutPoint(uint256(), 0)));
+
+    DBUnspentKey key;
+    for (; db_it->Valid(); db_it->Next()) {
+        if (!db_it->GetKey(key) || key.script_hash != script_hash) break;
+
+        DBUnspentValue value;
+        if (!db_it->GetValue(value)) {
+            return error("%s: unable to read value of unspent output %s", __func__, key.outpoint.ToString());
+        }
+        CAddressUnspent entry;
+        entry.outpoint = key.outpoint;
+        entry.amount = value.amount;
+        entry.height = value.height;
+        unspent.push_back(std::move(entry));
+    }
+    return true;
+}
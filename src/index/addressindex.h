@@ -0,0 +1,89 @@
+// Copyright (c) 2019-2020 Zentoshi LLC
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_ADDRESSINDEX_H
+#define BITCOIN_INDEX_ADDRESSINDEX_H
+
+#include <amount.h>
+#include <chain.h>
+#include <index/base.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <uint256.h>
+
+#include <vector>
+
+/** A change to the balance of a script: an output paying to it or an input spending from it. */
+struct CAddressDelta
+{
+    int height{0};
+    //! Position of the transaction in its block
+    uint32_t tx_index{0};
+    uint256 txid;
+    //! Output index, or input index if spending
+    uint32_t index{0};
+    bool spending{false};
+    CAmount amount{0};
+};
+
+/** An unspent output paying to a script. */
+struct CAddressUnspent
+{
+    COutPoint outpoint;
+    CAmount amount{0};
+    int height{0};
+};
+
+/**
+ * AddressIndex records, for every scriptPubKey used in the active chain, the history of outputs
+ * paying to it and inputs spending from it, its unspent outputs and its running balance. Scripts
+ * are keyed by their HASH160, with pay-to-pubkey scripts keyed as the pay-to-pubkey-hash script of
+ * the same key, so all lookups are a single LevelDB seek:
+ *
+ * - the balance and total received amount are one read,
+ * - the unspent outputs and the history (optionally restricted to a height range) are one
+ *   prefix scan over entries ordered by height and position in the block.
+ *
+ * Spent coins are taken from the block undo data. Each block is written in one batch, together with
+ * the locator of that block, so a block is never applied twice to the balances.
+ */
+class AddressIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+    /** Apply (or, with disconnect set, undo) the index entries of a block to a batch. */
+    bool ApplyBlock(CDBBatch& batch, const CBlock& block, const CBlockIndex* pindex, bool disconnect);
+
+    /** Add the locator of the block the balances include to a batch. */
+    void WriteLocator(CDBBatch& batch, const CBlockIndex* pindex);
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+    const char* GetName() const override { return "addressindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Look up the current balance and the total amount ever received by a script.
+    bool GetBalance(const CScript& script, CAmount& balance, CAmount& received) const;
+
+    /// Look up the history of a script between two heights (inclusive, end < 0 means no limit),
+    /// ordered by height and position in the block.
+    bool GetDeltas(const CScript& script, int start_height, int end_height, std::vector<CAddressDelta>& deltas) const;
+
+    /// Look up the unspent outputs paying to a script.
+    bool GetUnspent(const CScript& script, std::vector<CAddressUnspent>& unspent) const;
+};
+
+/// The global address index. May be null.
+extern std::unique_ptr<AddressIndex> g_addressindex;
+
+#endif // BITCOIN_INDEX_ADDRESSINDEX_H
@@ -4,6 +4,7 @@
 
 #include <chainparams.h>
 #include <index/base.h>
+#include <node/blockprefetch.h>
 #include <shutdown.h>
 #include <tinyformat.h>
 #include <ui_interface.h>
@@ -89,7 +90,8 @@ void BaseIndex::ThreadSync()
 {
     const CBlockIndex* pindex = m_best_block_index.load();
     if (!m_synced) {
-        auto& consensus_params = Params().GetConsensus();
+        // Read the following blocks on helper threads while the current one is being indexed.
+        BlockPrefetcher prefetcher(Params().GetConsensus(), GetName());
 
         int64_t last_log_time = 0;
         int64_t last_locator_write_time = 0;
@@ -128,15 +130,8 @@ void BaseIndex::ThreadSync()
                 last_log_time = current_time;
             }
 
-            if (last_locator_write_time + SYNC_LOCATOR_WRITE_INTERVAL < current_time) {
-                m_best_block_index = pindex;
-                last_locator_write_time = current_time;
-                // No need to handle errors in Commit. See rationale above.
-                Commit();
-            }
-
             CBlock block;
-            if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            if (!prefetcher.ReadBlock(pindex, block)) {
                 FatalError("%s: Failed to read block %s from disk",
                            __func__, pindex->GetBlockHash().ToString());
                 return;
@@ -146,6 +141,15 @@ void BaseIndex::ThreadSync()
                            __func__, pindex->GetBlockHash().ToString());
                 return;
             }
+
+            // Only commit blocks that were written, so that subclass state committed alongside
+            // the locator (e.g. the coinstatsindex running totals) matches the locator's tip.
+            if (last_locator_write_time + SYNC_LOCATOR_WRITE_INTERVAL < current_time) {
+                m_best_block_index = pindex;
+                last_locator_write_time = current_time;
+                // No need to handle errors in Commit. See rationale above.
+                Commit();
+            }
         }
     }
 
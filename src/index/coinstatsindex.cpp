@@ -0,0 +1,381 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <coins.h>
+#include <crypto/muhash.h>
+#include <index/coinstatsindex.h>
+#include <serialize.h>
+#include <undo.h>
+#include <util/system.h>
+#include <validation.h>
+
+/* The index database stores the UTXO set statistics of each block. Entries of blocks on the active
+ * chain are keyed by height, entries of blocks that have been reorganized out of the active chain
+ * are keyed by block hash, see blockfilterindex.cpp.
+ *
+ * The running MuHash state and totals of the best block of the index are stored under the
+ * DB_MUHASH key and are committed atomically with the best block locator.
+ *
+ * Keys for the height index have the type [DB_BLOCK_HEIGHT, uint32 (BE)].
+ * Keys for the hash index have the type [DB_BLOCK_HASH, uint256].
+ */
+constexpr char DB_BLOCK_HASH = 's';
+constexpr char DB_BLOCK_HEIGHT = 't';
+constexpr char DB_MUHASH = 'M';
+
+namespace {
+
+struct DBVal {
+    uint256 muhash;
+    uint64_t transaction_output_count;
+    uint64_t bogo_size;
+    CAmount total_amount;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(muhash);
+        READWRITE(transaction_output_count);
+        READWRITE(bogo_size);
+        READWRITE(total_amount);
+    }
+};
+
+struct DBState {
+    MuHash3072 muhash;
+    uint64_t transaction_output_count{0};
+    uint64_t bogo_size{0};
+    CAmount total_amount{0};
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(muhash);
+        READWRITE(transaction_output_count);
+        READWRITE(bogo_size);
+        READWRITE(total_amount);
+    }
+};
+
+struct DBHeightKey {
+    int height;
+
+    DBHeightKey() : height(0) {}
+    explicit DBHeightKey(int height_in) : height(height_in) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_BLOCK_HEIGHT);
+        ser_writedata32be(s, height);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        char prefix = ser_readdata8(s);
+        if (prefix != DB_BLOCK_HEIGHT) {
+            throw std::ios_base::failure("Invalid format for coinstatsindex DB height key");
+        }
+        height = ser_readdata32be(s);
+    }
+};
+
+struct DBHashKey {
+    uint256 hash;
+
+    explicit DBHashKey(const uint256& hash_in) : hash(hash_in) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        char prefix = DB_BLOCK_HASH;
+        READWRITE(prefix);
+        if (prefix != DB_BLOCK_HASH) {
+            throw std::ios_base::failure("Invalid format for coinstatsindex DB hash key");
+        }
+
+        READWRITE(hash);
+    }
+};
+
+}; // namespace
+
+std::unique_ptr<CoinStatsIndex> g_coin_stats_index;
+
+CoinStatsIndex::CoinStatsIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+{
+    fs::path path = GetDataDir() / "indexes" / "coinstats";
+    fs::create_directories(path);
+
+    m_name = "coinstatsindex";
+    m_db = MakeUnique<BaseIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+}
+
+bool CoinStatsIndex::Init()
+{
+    DBState state;
+    if (!m_db->Read(DB_MUHASH, state)) {
+        // Check that the cause of the read failure is that the key does not exist. Any other errors
+        // indicate database corruption or a disk failure, and starting the index would cause
+        // further corruption.
+        if (m_db->Exists(DB_MUHASH)) {
+            return error("%s: Cannot read current %s state; index may be corrupted",
+                         __func__, GetName());
+        }
+    }
+    m_muhash = state.muhash;
+    m_transaction_output_count = state.transaction_output_count;
+    m_bogo_size = state.bogo_size;
+    m_total_amount = state.total_amount;
+
+    if (!BaseIndex::Init()) {
+        return false;
+    }
+
+    CBlockLocator locator;
+    if (!m_db->ReadBestBlock(locator)) {
+        return true;
+    }
+
+    // The running state belongs to the tip of the stored locator. If that block was reorganized
+    // out while the node was down, BaseIndex resumes from the fork point, so the state has to be
+    // rolled back to it before any new block is applied.
+    const CBlockIndex* state_index;
+    const CBlockIndex* fork_index;
+    {
+        LOCK(cs_main);
+        state_index = LookupBlockIndex(locator.vHave.front());
+        fork_index = FindForkInGlobalIndex(::ChainActive(), locator);
+    }
+    if (!state_index) {
+        return error("%s: best block %s of %s is unknown", __func__, locator.vHave.front().ToString(), GetName());
+    }
+
+    const auto& consensus_params = Params().GetConsensus();
+    while (state_index != fork_index) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, state_index, consensus_params)) {
+            return error("%s: Failed to read block %s from disk",
+                         __func__, state_index->GetBlockHash().ToString());
+        }
+        if (!ReverseBlock(block, state_index)) {
+            return false;
+        }
+        state_index = state_index->pprev;
+    }
+
+    return true;
+}
+
+bool CoinStatsIndex::CommitInternal(CDBBatch& batch)
+{
+    DBState state;
+    state.muhash = m_muhash;
+    state.transaction_output_count = m_transaction_output_count;
+    state.bogo_size = m_bogo_size;
+    state.total_amount = m_total_amount;
+
+    batch.Write(DB_MUHASH, state);
+    return BaseIndex::CommitInternal(batch);
+}
+
+bool CoinStatsIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    // The genesis block outputs are not part of the UTXO set (see ConnectBlock)
+    if (pindex->nHeight > 0) {
+        CBlockUndo block_undo;
+        if (!UndoReadFromDisk(block_undo, pindex)) {
+            return false;
+        }
+
+        std::pair<uint256, DBVal> read_out;
+        if (!m_db->Read(DBHeightKey(pindex->nHeight - 1), read_out)) {
+            return false;
+        }
+
+        uint256 expected_block_hash = pindex->pprev->GetBlockHash();
+        if (read_out.first != expected_block_hash) {
+            return error("%s: previous block entry belongs to unexpected block %s; expected %s",
+                         __func__, read_out.first.ToString(), expected_block_hash.ToString());
+        }
+
+        for (size_t i = 0; i < block.vtx.size(); ++i) {
+            const auto& tx = block.vtx[i];
+
+            for (uint32_t j = 0; j < tx->vout.size(); ++j) {
+                const CTxOut& out = tx->vout[j];
+                // Same as AddCoins, unspendable outputs never enter the UTXO set
+                if (out.scriptPubKey.IsUnspendable()) continue;
+
+                Coin coin(out, pindex->nHeight, tx->IsCoinBase(), tx->IsCoinStake());
+                ApplyCoinHash(m_muhash, COutPoint(tx->GetHash(), j), coin);
+                ++m_transaction_output_count;
+                m_total_amount += out.nValue;
+                m_bogo_size += GetBogoSize(out.scriptPubKey);
+            }
+
+            if (tx->IsCoinBase()) continue;
+
+            const CTxUndo& tx_undo = block_undo.vtxundo.at(i - 1);
+            for (size_t j = 0; j < tx->vin.size(); ++j) {
+                const Coin& coin = tx_undo.vprevout[j];
+                RemoveCoinHash(m_muhash, tx->vin[j].prevout, coin);
+                --m_transaction_output_count;
+                m_total_amount -= coin.out.nValue;
+                m_bogo_size -= GetBogoSize(coin.out.scriptPubKey);
+            }
+        }
+    }
+
+    std::pair<uint256, DBVal> value;
+    value.first = pindex->GetBlockHash();
+    value.second.transaction_output_count = m_transaction_output_count;
+    value.second.bogo_size = m_bogo_size;
+    value.second.total_amount = m_total_amount;
+
+    // Finalize only combines numerator and denominator, the running state stays usable
+    m_muhash.Finalize(value.second.muhash);
+
+    return m_db->Write(DBHeightKey(pindex->nHeight), value);
+}
+
+bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    if (pindex->nHeight == 0) {
+        // Nothing of the genesis block was applied, see WriteBlock
+        return true;
+    }
+
+    CBlockUndo block_undo;
+    if (!UndoReadFromDisk(block_undo, pindex)) {
+        return error("%s: Failed to read undo data of block %s",
+                     __func__, pindex->GetBlockHash().ToString());
+    }
+
+    for (size_t i = block.vtx.size(); i-- > 0;) {
+        const auto& tx = block.vtx[i];
+
+        for (uint32_t j = 0; j < tx->vout.size(); ++j) {
+            const CTxOut& out = tx->vout[j];
+            if (out.scriptPubKey.IsUnspendable()) continue;
+
+            Coin coin(out, pindex->nHeight, tx->IsCoinBase(), tx->IsCoinStake());
+            RemoveCoinHash(m_muhash, COutPoint(tx->GetHash(), j), coin);
+            --m_transaction_output_count;
+            m_total_amount -= out.nValue;
+            m_bogo_size -= GetBogoSize(out.scriptPubKey);
+        }
+
+        if (tx->IsCoinBase()) continue;
+
+        const CTxUndo& tx_undo = block_undo.vtxundo.at(i - 1);
+        for (size_t j = 0; j < tx->vin.size(); ++j) {
+            const Coin& coin = tx_undo.vprevout[j];
+            ApplyCoinHash(m_muhash, tx->vin[j].prevout, coin);
+            ++m_transaction_output_count;
+            m_total_amount += coin.out.nValue;
+            m_bogo_size += GetBogoSize(coin.out.scriptPubKey);
+        }
+    }
+
+    return true;
+}
+
+static bool CopyHeightIndexToHashIndex(CDBIterator& db_it, CDBBatch& batch,
+                                       const std::string& index_name,
+                                       int start_height, int stop_height)
+{
+    DBHeightKey key(start_height);
+    db_it.Seek(key);
+
+    for (int height = start_height; height <= stop_height; ++height) {
+        if (!db_it.GetKey(key) || key.height != height) {
+            return error("%s: unexpected key in %s: expected (%c, %d)",
+                         __func__, index_name, DB_BLOCK_HEIGHT, height);
+        }
+
+        std::pair<uint256, DBVal> value;
+        if (!db_it.GetValue(value)) {
+            return error("%s: unable to read value in %s at key (%c, %d)",
+                         __func__, index_name, DB_BLOCK_HEIGHT, height);
+        }
+
+        batch.Write(DBHashKey(value.first), std::move(value.second));
+
+        db_it.Next();
+    }
+    return true;
+}
+
+bool CoinStatsIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    CDBBatch batch(*m_db);
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+
+    // During a reorg, we need to copy all entries for blocks that are getting disconnected from the
+    // height index to the hash index so we can still find them when the height index entries are
+    // overwritten.
+    if (!CopyHeightIndexToHashIndex(*db_it, batch, m_name, new_tip->nHeight, current_tip->nHeight)) {
+        return false;
+    }
+
+    if (!m_db->WriteBatch(batch)) return false;
+
+    const auto& consensus_params = Params().GetConsensus();
+    for (const CBlockIndex* pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            return error("%s: Failed to read block %s from disk",
+                         __func__, pindex->GetBlockHash().ToString());
+        }
+        if (!ReverseBlock(block, pindex)) {
+            return false;
+        }
+    }
+
+    // The running state is written together with the new best block by BaseIndex::Rewind
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+static bool LookUpOne(const CDBWrapper& db, const CBlockIndex* block_index, DBVal& result)
+{
+    // First check if the result is stored under the height index and the value there matches the
+    // block hash. This should be the case if the block is on the active chain.
+    std::pair<uint256, DBVal> read_out;
+    if (!db.Read(DBHeightKey(block_index->nHeight), read_out)) {
+        return false;
+    }
+    if (read_out.first == block_index->GetBlockHash()) {
+        result = std::move(read_out.second);
+        return true;
+    }
+
+    // If value at the height index corresponds to an different block, the result will be stored in
+    // the hash index.
+    return db.Read(DBHashKey(block_index->GetBlockHash()), result);
+}
+
+bool CoinStatsIndex::LookUpStats(const CBlockIndex* block_index, CCoinsStats& coins_stats) const
+{
+    DBVal entry;
+    if (!LookUpOne(*m_db, block_index, entry)) {
+        return false;
+    }
+
+    coins_stats.nHeight = block_index->nHeight;
+    coins_stats.hashBlock = block_index->GetBlockHash();
+    coins_stats.hashSerialized = entry.muhash;
+    coins_stats.nTransactionOutputs = entry.transaction_output_count;
+    coins_stats.nBogoSize = entry.bogo_size;
+    coins_stats.nTotalAmount = entry.total_amount;
+
+    return true;
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2019-2020 Zentoshi LLC
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <index/spentindex.h>
+#include <util/system.h>
+#include <validation.h>
+
+constexpr char DB_SPENT = 'p';
+
+std::unique_ptr<SpentIndex> g_spentindex;
+
+namespace {
+
+struct DBSpentKey {
+    COutPoint outpoint;
+
+    explicit DBSpentKey(const COutPoint& outpoint_in) : outpoint(outpoint_in) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        char prefix = DB_SPENT;
+        READWRITE(prefix);
+        if (prefix != DB_SPENT) {
+            throw std::ios_base::failure("Invalid format for spentindex DB key");
+        }
+
+        READWRITE(outpoint);
+    }
+};
+
+}; // namespace
+
+SpentIndex::SpentIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<BaseIndex::DB>(GetDataDir() / "indexes" / "spentindex", n_cache_size, f_memory, f_wipe))
+{}
+
+bool SpentIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    CDBBatch batch(*m_db);
+    CSpentIndexValue value;
+    value.height = pindex->nHeight;
+    for (const auto& tx : block.vtx) {
+        if (tx->IsCoinBase()) continue;
+        value.txid = tx->GetHash();
+        for (uint32_t i = 0; i < tx->vin.size(); ++i) {
+            value.input_index = i;
+            batch.Write(DBSpentKey(tx->vin[i].prevout), value);
+        }
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool SpentIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    const auto& consensus_params = Params().GetConsensus();
+    CDBBatch batch(*m_db);
+    for (const CBlockIndex* pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            return error("%s: Failed to read block %s from disk",
+                         __func__, pindex->GetBlockHash().ToString());
+        }
+        for (const auto& tx : block.vtx) {
+            if (tx->IsCoinBase()) continue;
+            for (const auto& txin : tx->vin) {
+                batch.Erase(DBSpentKey(txin.prevout));
+            }
+        }
+    }
+    if (!m_db->WriteBatch(batch)) return false;
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+bool SpentIndex::FindSpent(const COutPoint& outpoint, CSpentIndexValue& value) const
+{
+    return m_db->Read(DBSpentKey(outpoint), value);
+}
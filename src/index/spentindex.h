@@ -0,0 +1,64 @@
+// Copyright (c) 2019-2020 Zentoshi LLC
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_SPENTINDEX_H
+#define BITCOIN_INDEX_SPENTINDEX_H
+
+#include <chain.h>
+#include <index/base.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <uint256.h>
+
+/** Where an outpoint was spent: the spending transaction, its input index and the block height. */
+struct CSpentIndexValue
+{
+    uint256 txid;
+    uint32_t input_index{0};
+    int height{0};
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(txid);
+        READWRITE(input_index);
+        READWRITE(height);
+    }
+};
+
+/**
+ * SpentIndex maps every outpoint spent in the active chain to the transaction input spending it.
+ * The index is written to a LevelDB database, one batch per block.
+ */
+class SpentIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+    const char* GetName() const override { return "spentindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit SpentIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Look up the input spending an outpoint.
+    ///
+    /// @param[in]   outpoint  The spent outpoint.
+    /// @param[out]  value  The spending transaction, input index and block height.
+    /// @return  true if the outpoint was spent in the indexed chain, false otherwise
+    bool FindSpent(const COutPoint& outpoint, CSpentIndexValue& value) const;
+};
+
+/// The global spent index. May be null.
+extern std::unique_ptr<SpentIndex> g_spentindex;
+
+#endif // BITCOIN_INDEX_SPENTINDEX_H
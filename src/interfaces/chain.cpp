@@ -10,6 +10,7 @@
 #include <interfaces/wallet.h>
 #include <net.h>
 #include <net_processing.h>
+#include <node/blockprefetch.h>
 #include <node/coin.h>
 #include <node/transaction.h>
 #include <policy/fees.h>
@@ -237,6 +238,30 @@ public:
     const CRPCCommand* m_wrapped_command;
 };
 
+class BlockReaderImpl : public Chain::BlockReader
+{
+public:
+    BlockReaderImpl() : m_prefetcher(Params().GetConsensus(), "rescan") {}
+
+    bool readBlock(const uint256& hash, CBlock& block) override
+    {
+        CBlockIndex* index;
+        {
+            LOCK(cs_main);
+            index = LookupBlockIndex(hash);
+            if (!index) {
+                return false;
+            }
+        }
+        if (!m_prefetcher.ReadBlock(index, block)) {
+            block.SetNull();
+        }
+        return true;
+    }
+
+    BlockPrefetcher m_prefetcher;
+};
+
 class ChainImpl : public Chain
 {
 public:
@@ -269,6 +294,7 @@ public:
         }
         return true;
     }
+    std::unique_ptr<BlockReader> makeBlockReader() override { return MakeUnique<BlockReaderImpl>(); }
     void findCoins(std::map<COutPoint, Coin>& coins) override { return FindCoins(coins); }
     double guessVerificationProgress(const uint256& block_hash) override
     {
@@ -140,6 +140,22 @@ public:
         int64_t* time = nullptr,
         int64_t* max_time = nullptr) = 0;
 
+    //! Interface for reading the blocks of the active chain in ascending order,
+    //! for example during a rescan. The blocks following the last one read are
+    //! loaded ahead of time on helper threads.
+    class BlockReader
+    {
+    public:
+        virtual ~BlockReader() {}
+
+        //! Read a block. Same semantics as findBlock with a block pointer.
+        virtual bool readBlock(const uint256& hash, CBlock& block) = 0;
+    };
+
+    //! Return BlockReader interface. Helper threads are stopped when the
+    //! returned interface is freed.
+    virtual std::unique_ptr<BlockReader> makeBlockReader() = 0;
+
     //! Look up unspent output information. Returns coins in the mempool and in
     //! the current chain UTXO set. Iterates through all the keys in the map and
     //! populates the values.
@@ -314,27 +314,23 @@ void CChainLocksHandler::TrySignChainTip()
                 break;
             }
 
-            auto txids = GetBlockTxs(pindexWalk->GetBlockHash());
-            if (!txids) {
+            auto txs = GetBlockTxs(pindexWalk->GetBlockHash());
+            if (!txs) {
                 pindexWalk = pindexWalk->pprev;
                 continue;
             }
 
-            for (auto& txid : *txids) {
-                int64_t txAge = 0;
-                {
-                    LOCK(cs);
-                    auto it = txFirstSeenTime.find(txid);
-                    if (it != txFirstSeenTime.end()) {
-                        txAge = GetAdjustedTime() - it->second;
-                    }
-                }
-
-                if (txAge < WAIT_FOR_ISLOCK_TIMEOUT && !quorumInstantSendManager->IsLocked(txid)) {
-                    LogPrint(BCLog::CHAINLOCKS, "CChainLocksHandler::%s -- not signing block %s due to TX %s not being ixlocked and not old enough. age=%d\n", __func__,
-                              pindexWalk->GetBlockHash().ToString(), txid.ToString(), txAge);
-                    return;
-                }
+            uint256 unsafeTxid;
+            int64_t txAge;
+            bool safe;
+            {
+                LOCK(cs);
+                safe = IsBlockSafe(*txs, unsafeTxid, txAge);
+            }
+            if (!safe) {
+                LogPrint(BCLog::CHAINLOCKS, "CChainLocksHandler::%s -- not signing block %s due to TX %s not being ixlocked and not old enough. age=%d\n", __func__,
+                          pindexWalk->GetBlockHash().ToString(), unsafeTxid.ToString(), txAge);
+                return;
             }
 
             pindexWalk = pindexWalk->pprev;
@@ -382,34 +378,45 @@ void CChainLocksHandler::BlockConnected(const std::shared_ptr<const CBlock>& pbl
     // We listen for BlockConnected so that we can collect all TX ids of all included TXs of newly received blocks
     // We need this information later when we try to sign a new tip, so that we can determine if all included TXs are
     // safe.
+    // We must create this entry even if there are no lockable transactions in the block, so that TrySignChainTip
+    // later knows about this block
+    AddBlockTxs(pindex->GetBlockHash(), pblock->vtx, GetAdjustedTime());
+}
 
+void CChainLocksHandler::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexDisconnected)
+{
     LOCK(cs);
-
-    auto it = blockTxs.find(pindex->GetBlockHash());
-    if (it == blockTxs.end()) {
-        // we must create this entry even if there are no lockable transactions in the block, so that TrySignChainTip
-        // later knows about this block
-        it = blockTxs.emplace(pindex->GetBlockHash(), std::make_shared<std::unordered_set<uint256, StaticSaltedHasher>>()).first;
+    auto it = blockTxs.find(pindexDisconnected->GetBlockHash());
+    if (it != blockTxs.end()) {
+        RemoveBlockTxs(it);
     }
-    auto& txids = *it->second;
-
-    int64_t curTime = GetAdjustedTime();
+}
 
-    for (const auto& tx : pblock->vtx) {
-        if (tx->IsCoinBase() || tx->vin.empty()) {
-            continue;
+void CChainLocksHandler::NotifyTxLocked(const uint256& txid)
+{
+    LOCK(cs);
+    auto range = txBlocks.equal_range(txid);
+    for (auto it = range.first; it != range.second; ++it) {
+        auto it2 = blockTxs.find(it->second);
+        if (it2 != blockTxs.end()) {
+            it2->second->notLockedTxids.erase(txid);
         }
-
-        txids.emplace(tx->GetHash());
-        txFirstSeenTime.emplace(tx->GetHash(), curTime);
     }
-
 }
 
-void CChainLocksHandler::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexDisconnected)
+// Called when an ISLOCK got removed again, e.g. because it conflicted with a ChainLock. The TX must then be treated as
+// not ixlocked again in all blocks which include it
+void CChainLocksHandler::NotifyTxUnlocked(const uint256& txid)
 {
     LOCK(cs);
-    blockTxs.erase(pindexDisconnected->GetBlockHash());
+    txUnlockedCount++;
+    auto range = txBlocks.equal_range(txid);
+    for (auto it = range.first; it != range.second; ++it) {
+        auto it2 = blockTxs.find(it->second);
+        if (it2 != blockTxs.end()) {
+            it2->second->notLockedTxids.emplace(txid);
+        }
+    }
 }
 
 CChainLocksHandler::BlockTxs::mapped_type CChainLocksHandler::GetBlockTxs(const uint256& blockHash)
@@ -417,48 +424,124 @@ CChainLocksHandler::BlockTxs::mapped_type CChainLocksHandler::GetBlockTxs(const
     AssertLockNotHeld(cs);
     AssertLockNotHeld(cs_main);
 
-    CChainLocksHandler::BlockTxs::mapped_type ret;
-
     {
         LOCK(cs);
         auto it = blockTxs.find(blockHash);
         if (it != blockTxs.end()) {
-            ret = it->second;
+            return it->second;
         }
     }
-    if (!ret) {
-        // This should only happen when freshly started.
-        // If running for some time, SyncTransaction should have been called before which fills blockTxs.
-        LogPrint(BCLog::CHAINLOCKS, "CChainLocksHandler::%s -- blockTxs for %s not found. Trying ReadBlockFromDisk\n", __func__,
-                 blockHash.ToString());
 
-        uint32_t blockTime;
-        {
-            LOCK(cs_main);
-            auto pindex = ::BlockIndex().at(blockHash);
-            CBlock block;
-            if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
-                return nullptr;
+    // This should only happen when freshly started.
+    // If running for some time, SyncTransaction should have been called before which fills blockTxs.
+    LogPrint(BCLog::CHAINLOCKS, "CChainLocksHandler::%s -- blockTxs for %s not found. Trying ReadBlockFromDisk\n", __func__,
+             blockHash.ToString());
+
+    CBlock block;
+    {
+        LOCK(cs_main);
+        auto pindex = ::BlockIndex().at(blockHash);
+        if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            return nullptr;
+        }
+    }
+
+    return AddBlockTxs(blockHash, block.vtx, block.nTime);
+}
+
+// Registers the TXs of a block with all of them initially being treated as not ixlocked. Only after registration,
+// CInstantSendManager is asked for the TXs which are already ixlocked. This ensures that an ISLOCK which arrives
+// in-between is not missed, as it is then handled by NotifyTxLocked
+CChainLocksHandler::BlockTxs::mapped_type CChainLocksHandler::AddBlockTxs(const uint256& blockHash, const std::vector<CTransactionRef>& vtx, int64_t firstSeenTime)
+{
+    AssertLockNotHeld(cs);
+
+    BlockTxs::mapped_type info;
+    uint64_t unlockedCountBefore;
+    {
+        LOCK(cs);
+        auto it = blockTxs.find(blockHash);
+        if (it != blockTxs.end()) {
+            return it->second;
+        }
+        unlockedCountBefore = txUnlockedCount;
+
+        info = std::make_shared<BlockTxsInfo>();
+        for (const auto& tx : vtx) {
+            if (tx->IsCoinBase() || tx->vin.empty()) {
+                continue;
+            }
+            const uint256& txid = tx->GetHash();
+            if (!info->txids.emplace(txid).second) {
+                continue;
             }
+            info->notLockedTxids.emplace(txid);
+            txBlocks.emplace(txid, blockHash);
+            txFirstSeenTime.emplace(txid, firstSeenTime);
+        }
+        blockTxs.emplace(blockHash, info);
+    }
 
-            ret = std::make_shared<std::unordered_set<uint256, StaticSaltedHasher>>();
-            for (auto& tx : block.vtx) {
-                if (tx->IsCoinBase() || tx->vin.empty()) {
-                    continue;
-                }
-                ret->emplace(tx->GetHash());
+    // txids is never modified after creation, so it's safe to access it without holding cs
+    std::vector<uint256> lockedTxids;
+    for (const auto& txid : info->txids) {
+        if (quorumInstantSendManager->IsLocked(txid)) {
+            lockedTxids.emplace_back(txid);
+        }
+    }
+    if (!lockedTxids.empty()) {
+        LOCK(cs);
+        // If an ISLOCK got removed in-between, IsLocked might have reported a TX which is not ixlocked anymore. Keep
+        // all TXs as not ixlocked then, they become safe once they are old enough
+        if (txUnlockedCount == unlockedCountBefore) {
+            for (const auto& txid : lockedTxids) {
+                info->notLockedTxids.erase(txid);
             }
+        }
+    }
 
-            blockTime = block.nTime;
+    return info;
+}
+
+CChainLocksHandler::BlockTxs::iterator CChainLocksHandler::RemoveBlockTxs(BlockTxs::iterator it)
+{
+    AssertLockHeld(cs);
+
+    for (const auto& txid : it->second->txids) {
+        auto range = txBlocks.equal_range(txid);
+        for (auto it2 = range.first; it2 != range.second; ) {
+            if (it2->second == it->first) {
+                it2 = txBlocks.erase(it2);
+            } else {
+                ++it2;
+            }
         }
+    }
+    return blockTxs.erase(it);
+}
 
-        LOCK(cs);
-        blockTxs.emplace(blockHash, ret);
-        for (auto& txid : *ret) {
-            txFirstSeenTime.emplace(txid, blockTime);
+// A block is safe when all of its TXs are either ixlocked or known for at least WAIT_FOR_ISLOCK_TIMEOUT. As ixlocked
+// TXs are removed from notLockedTxids when the ISLOCK arrives, only the remaining ones need to be checked here
+bool CChainLocksHandler::IsBlockSafe(BlockTxsInfo& info, uint256& retUnsafeTxid, int64_t& retTxAge)
+{
+    AssertLockHeld(cs);
+
+    int64_t curTime = GetAdjustedTime();
+    for (auto it = info.notLockedTxids.begin(); it != info.notLockedTxids.end(); ) {
+        int64_t txAge = 0;
+        auto it2 = txFirstSeenTime.find(*it);
+        if (it2 != txFirstSeenTime.end()) {
+            txAge = curTime - it2->second;
         }
+        if (txAge < WAIT_FOR_ISLOCK_TIMEOUT) {
+            retUnsafeTxid = *it;
+            retTxAge = txAge;
+            return false;
+        }
+        // old enough, no need to check it again
+        it = info.notLockedTxids.erase(it);
     }
-    return ret;
+    return true;
 }
 
 bool CChainLocksHandler::IsTxSafeForMining(const uint256& txid)
@@ -705,12 +788,12 @@ void CChainLocksHandler::Cleanup()
     for (auto it = blockTxs.begin(); it != blockTxs.end(); ) {
         auto pindex = ::BlockIndex().at(it->first);
         if (InternalHasChainLock(pindex->nHeight, pindex->GetBlockHash())) {
-            for (auto& txid : *it->second) {
+            for (auto& txid : it->second->txids) {
                 txFirstSeenTime.erase(txid);
             }
-            it = blockTxs.erase(it);
+            it = RemoveBlockTxs(it);
         } else if (InternalHasConflictingChainLock(pindex->nHeight, pindex->GetBlockHash())) {
-            it = blockTxs.erase(it);
+            it = RemoveBlockTxs(it);
         } else {
             ++it;
         }
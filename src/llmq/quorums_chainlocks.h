@@ -69,9 +69,19 @@ private:
     uint256 lastSignedMsgHash;
 
     // We keep track of txids from recently received blocks so that we can check if all TXs got ixlocked
-    typedef std::unordered_map<uint256, std::shared_ptr<std::unordered_set<uint256, StaticSaltedHasher>>> BlockTxs;
+    // The txids which were not ixlocked yet are tracked separately per block. This set is updated incrementally when
+    // ISLOCKs arrive, so that checking a block for safety doesn't require querying CInstantSendManager for each TX
+    struct BlockTxsInfo {
+        std::unordered_set<uint256, StaticSaltedHasher> txids;
+        std::unordered_set<uint256, StaticSaltedHasher> notLockedTxids;
+    };
+    typedef std::unordered_map<uint256, std::shared_ptr<BlockTxsInfo>> BlockTxs;
     BlockTxs blockTxs;
+    // txid -> hashes of all blocks in blockTxs which include the TX (more than one only after reorgs)
+    std::unordered_multimap<uint256, uint256, StaticSaltedHasher> txBlocks;
     std::unordered_map<uint256, int64_t> txFirstSeenTime;
+    // incremented by NotifyTxUnlocked, lets AddBlockTxs detect ISLOCKs removed while it queried CInstantSendManager
+    uint64_t txUnlockedCount{0};
 
     std::map<uint256, int64_t> seenChainLocks;
 
@@ -95,6 +105,8 @@ public:
     void TransactionAddedToMempool(const CTransactionRef& tx);
     void BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex, const std::vector<CTransactionRef>& vtxConflicted);
     void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexDisconnected);
+    void NotifyTxLocked(const uint256& txid);
+    void NotifyTxUnlocked(const uint256& txid);
     void CheckActiveState();
     void TrySignChainTip();
     void EnforceBestChainLock();
@@ -113,6 +125,9 @@ private:
     void DoInvalidateBlock(const CBlockIndex* pindex, bool activateBestChain);
 
     BlockTxs::mapped_type GetBlockTxs(const uint256& blockHash);
+    BlockTxs::mapped_type AddBlockTxs(const uint256& blockHash, const std::vector<CTransactionRef>& vtx, int64_t firstSeenTime);
+    BlockTxs::iterator RemoveBlockTxs(BlockTxs::iterator it);
+    bool IsBlockSafe(BlockTxsInfo& info, uint256& retUnsafeTxid, int64_t& retTxAge);
 
     void Cleanup();
 };
@@ -189,7 +189,7 @@ void CDKGSession::SendContributions(CDKGPendingMessages& pendingMessages)
 }
 
 // only performs cheap verifications, but not the signature of the message. this is checked with batched verification
-bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGContribution& qc, bool& retBan) const
+bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGContribution& qc, size_t nBatched, bool& retBan) const
 {
     cxxtimer::Timer t1(true);
 
@@ -218,21 +218,49 @@ bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGContribution&
         return false;
     }
 
+    if (member->contributions.size() + nBatched >= 2) {
+        // don't do any further processing if we got more than 1 valid contributions already
+        // this is a DoS protection against members sending multiple contributions with valid signatures to us
+        // we must bail out before any expensive BLS verification happens
+        LogPrint(BCLog::QUORUM, "dropping contribution from %s as we already got %d contributions", member->dmn->proTxHash.ToString(), member->contributions.size() + nBatched);
+        return false;
+    }
+
     if (!blsWorker.VerifyVerificationVector(*qc.vvec)) {
         LogPrint(BCLog::QUORUM, "invalid verification vector");
         retBan = true;
         return false;
     }
 
-    if (member->contributions.size() >= 2) {
-        // don't do any further processing if we got more than 1 valid contributions already
-        // this is a DoS protection against members sending multiple contributions with valid signatures to us
-        // we must bail out before any expensive BLS verification happens
-        LogPrint(BCLog::QUORUM, "dropping contribution from %s as we already got %d contributions", member->dmn->proTxHash.ToString(), member->contributions.size());
-        return false;
+    return true;
+}
+
+// Decrypts our own secret key contributions of a whole batch of contributions in parallel
+void CDKGSession::PreProcessMessages(const std::vector<uint256>& hashes, const std::vector<std::pair<NodeId, std::shared_ptr<CDKGContribution>>>& msgs)
+{
+    if (!AreWeMember() || msgs.empty()) {
+        return;
     }
 
-    return true;
+    cxxtimer::Timer t1(true);
+
+    std::vector<std::pair<bool, CBLSSecretKey>> results(msgs.size());
+    std::vector<std::function<void()>> jobs;
+    jobs.reserve(msgs.size());
+    for (size_t i = 0; i < msgs.size(); i++) {
+        const auto& qc = *msgs[i].second;
+        auto& result = results[i];
+        jobs.emplace_back([this, &qc, &result]() {
+            result.first = qc.contributions->Decrypt(myIdx, *activeMasternodeInfo.blsKeyOperator, result.second, PROTOCOL_VERSION);
+        });
+    }
+    blsWorker.RunJobsAndWait(jobs);
+
+    for (size_t i = 0; i < msgs.size(); i++) {
+        decryptedContributions[hashes[i]] = std::move(results[i]);
+    }
+
+    LogPrint(BCLog::QUORUM, "decrypted %d contributions. time=%d", msgs.size(), t1.count());
 }
 
 void CDKGSession::ReceiveMessage(const uint256& hash, const CDKGContribution& qc, bool& retBan)
@@ -241,6 +269,15 @@ void CDKGSession::ReceiveMessage(const uint256& hash, const CDKGContribution& qc
 
     auto member = GetMember(qc.proTxHash);
 
+    bool havePreDecrypted = false;
+    std::pair<bool, CBLSSecretKey> preDecrypted;
+    auto decryptedIt = decryptedContributions.find(hash);
+    if (decryptedIt != decryptedContributions.end()) {
+        havePreDecrypted = true;
+        preDecrypted = std::move(decryptedIt->second);
+        decryptedContributions.erase(decryptedIt);
+    }
+
     cxxtimer::Timer t1(true);
     LogPrint(BCLog::QUORUM, "received contribution from %s", qc.proTxHash.ToString());
 
@@ -297,7 +334,14 @@ void CDKGSession::ReceiveMessage(const uint256& hash, const CDKGContribution& qc
 
     bool complain = false;
     CBLSSecretKey skContribution;
-    if (!qc.contributions->Decrypt(myIdx, *activeMasternodeInfo.blsKeyOperator, skContribution, PROTOCOL_VERSION)) {
+    bool decrypted;
+    if (havePreDecrypted) {
+        decrypted = preDecrypted.first;
+        skContribution = preDecrypted.second;
+    } else {
+        decrypted = qc.contributions->Decrypt(myIdx, *activeMasternodeInfo.blsKeyOperator, skContribution, PROTOCOL_VERSION);
+    }
+    if (!decrypted) {
         LogPrint(BCLog::QUORUM, "contribution from %s could not be decrypted", member->dmn->proTxHash.ToString());
         complain = true;
     } else if (member->idx != myIdx && ShouldSimulateError("complain-lie")) {
@@ -452,7 +496,7 @@ void CDKGSession::SendComplaint(CDKGPendingMessages& pendingMessages)
 }
 
 // only performs cheap verifications, but not the signature of the message. this is checked with batched verification
-bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGComplaint& qc, bool& retBan) const
+bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGComplaint& qc, size_t nBatched, bool& retBan) const
 {
     retBan = false;
 
@@ -480,12 +524,12 @@ bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGComplaint& qc,
         return false;
     }
 
-    if (member->complaints.size() >= 2) {
+    if (member->complaints.size() + nBatched >= 2) {
         // don't do any further processing if we got more than 1 valid complaints already
         // this is a DoS protection against members sending multiple complaints with valid signatures to us
         // we must bail out before any expensive BLS verification happens
         LogPrint(BCLog::QUORUM, "dropping complaint from %s as we already got %d complaints",
-                      member->dmn->proTxHash.ToString(), member->complaints.size());
+                      member->dmn->proTxHash.ToString(), member->complaints.size() + nBatched);
         return false;
     }
 
@@ -639,7 +683,7 @@ void CDKGSession::SendJustification(CDKGPendingMessages& pendingMessages, const
 }
 
 // only performs cheap verifications, but not the signature of the message. this is checked with batched verification
-bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGJustification& qj, bool& retBan) const
+bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGJustification& qj, size_t nBatched, bool& retBan) const
 {
     retBan = false;
 
@@ -683,12 +727,12 @@ bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGJustification&
         }
     }
 
-    if (member->justifications.size() >= 2) {
+    if (member->justifications.size() + nBatched >= 2) {
         // don't do any further processing if we got more than 1 valid justification already
         // this is a DoS protection against members sending multiple justifications with valid signatures to us
         // we must bail out before any expensive BLS verification happens
         LogPrint(BCLog::QUORUM, "dropping justification from %s as we already got %d justifications",
-                      member->dmn->proTxHash.ToString(), member->justifications.size());
+                      member->dmn->proTxHash.ToString(), member->justifications.size() + nBatched);
         return false;
     }
 
@@ -949,7 +993,7 @@ void CDKGSession::SendCommitment(CDKGPendingMessages& pendingMessages)
 }
 
 // only performs cheap verifications, but not the signature of the message. this is checked with batched verification
-bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGPrematureCommitment& qc, bool& retBan) const
+bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGPrematureCommitment& qc, size_t nBatched, bool& retBan) const
 {
     cxxtimer::Timer t1(true);
 
@@ -997,12 +1041,95 @@ bool CDKGSession::PreVerifyMessage(const uint256& hash, const CDKGPrematureCommi
         }
     }
 
-    if (member->prematureCommitments.size() >= 2) {
+    if (member->prematureCommitments.size() + nBatched >= 2) {
         // don't do any further processing if we got more than 1 valid commitment already
         // this is a DoS protection against members sending multiple commitments with valid signatures to us
         // we must bail out before any expensive BLS verification happens
         LogPrint(BCLog::QUORUM, "dropping commitment from %s as we already got %d commitments",
-                      member->dmn->proTxHash.ToString(), member->prematureCommitments.size());
+                      member->dmn->proTxHash.ToString(), member->prematureCommitments.size() + nBatched);
+        return false;
+    }
+
+    return true;
+}
+
+// Verifies a whole batch of premature commitments in parallel. The quorum verification vectors are built up-front on the
+// calling thread, as building them uses the BLS worker itself
+void CDKGSession::PreProcessMessages(const std::vector<uint256>& hashes, const std::vector<std::pair<NodeId, std::shared_ptr<CDKGPrematureCommitment>>>& msgs)
+{
+    if (msgs.empty()) {
+        return;
+    }
+
+    cxxtimer::Timer t1(true);
+
+    std::map<std::vector<bool>, std::pair<std::vector<uint16_t>, BLSVerificationVectorPtr>> quorumVvecs;
+    for (const auto& p : msgs) {
+        const auto& qc = *p.second;
+        if (quorumVvecs.count(qc.validMembers)) {
+            continue;
+        }
+        std::vector<uint16_t> memberIndexes;
+        std::vector<BLSVerificationVectorPtr> vvecs;
+        BLSSecretKeyVector skContributions;
+        BLSVerificationVectorPtr quorumVvec;
+        if (dkgManager.GetVerifiedContributions(params.type, pindexQuorum, qc.validMembers, memberIndexes, vvecs, skContributions)) {
+            quorumVvec = cache.BuildQuorumVerificationVector(::SerializeHash(memberIndexes), vvecs);
+        }
+        quorumVvecs.emplace(qc.validMembers, std::make_pair(std::move(memberIndexes), std::move(quorumVvec)));
+    }
+
+    // not using std::vector<bool> as it's not safe to write to it from multiple threads
+    std::vector<uint8_t> results(msgs.size());
+    std::vector<size_t> verifiedIndexes;
+    std::vector<std::function<void()>> jobs;
+    jobs.reserve(msgs.size());
+    for (size_t i = 0; i < msgs.size(); i++) {
+        const auto& qc = *msgs[i].second;
+        const auto& vvecInfo = quorumVvecs.at(qc.validMembers);
+        if (vvecInfo.second == nullptr) {
+            // ReceiveMessage will handle this
+            continue;
+        }
+        auto& result = results[i];
+        jobs.emplace_back([this, &qc, &vvecInfo, &result]() {
+            result = VerifyPrematureCommitment(qc, vvecInfo.first, vvecInfo.second);
+        });
+        verifiedIndexes.emplace_back(i);
+    }
+    blsWorker.RunJobsAndWait(jobs);
+
+    for (size_t i : verifiedIndexes) {
+        verifiedPrematureCommitments[hashes[i]] = results[i] != 0;
+    }
+
+    LogPrint(BCLog::QUORUM, "verified %d premature commitments. time=%d", verifiedIndexes.size(), t1.count());
+}
+
+// Verifies everything that can be verified with the given quorum verification vector (even though we might not be a
+// member of the quorum). Thread safe, so that it can be run on the BLS worker
+bool CDKGSession::VerifyPrematureCommitment(const CDKGPrematureCommitment& qc, const std::vector<uint16_t>& memberIndexes, const BLSVerificationVectorPtr& quorumVvec)
+{
+    auto member = GetMember(qc.proTxHash);
+
+    if ((*quorumVvec)[0] != qc.quorumPublicKey) {
+        LogPrint(BCLog::QUORUM, "calculated quorum public key does not match");
+        return false;
+    }
+    uint256 vvecHash = ::SerializeHash(*quorumVvec);
+    if (qc.quorumVvecHash != vvecHash) {
+        LogPrint(BCLog::QUORUM, "calculated quorum vvec hash does not match");
+        return false;
+    }
+
+    CBLSPublicKey pubKeyShare = cache.BuildPubKeyShare(::SerializeHash(std::make_pair(memberIndexes, member->id)), quorumVvec, member->id);
+    if (!pubKeyShare.IsValid()) {
+        LogPrint(BCLog::QUORUM, "failed to calculate public key share");
+        return false;
+    }
+
+    if (!qc.quorumSig.VerifyInsecure(pubKeyShare, qc.GetSignHash())) {
+        LogPrint(BCLog::QUORUM, "failed to verify quorumSig");
         return false;
     }
 
@@ -1022,48 +1149,42 @@ void CDKGSession::ReceiveMessage(const uint256& hash, const CDKGPrematureCommitm
     {
         LOCK(invCs);
 
+        if (member->prematureCommitments.size() >= 2) {
+            // only relay up to 2 commitments, that's enough to let the other members know about his bad behavior
+            verifiedPrematureCommitments.erase(hash);
+            return;
+        }
+
         // keep track of ALL commitments but only relay valid ones (or if we couldn't build the vvec)
         // relaying is done further down
         prematureCommitments.emplace(hash, qc);
         member->prematureCommitments.emplace(hash);
     }
 
-    std::vector<uint16_t> memberIndexes;
-    std::vector<BLSVerificationVectorPtr> vvecs;
-    BLSSecretKeyVector skContributions;
-    BLSVerificationVectorPtr quorumVvec;
-    if (dkgManager.GetVerifiedContributions(params.type, pindexQuorum, qc.validMembers, memberIndexes, vvecs, skContributions)) {
-        quorumVvec = cache.BuildQuorumVerificationVector(::SerializeHash(memberIndexes), vvecs);
-    }
-
-    if (quorumVvec == nullptr) {
-        LogPrint(BCLog::QUORUM, "failed to build quorum verification vector. skipping full verification");
-        // we might be the unlucky one who didn't receive all contributions, but we still have to relay
-        // the premature commitment as others might be luckier
-    } else {
-        // we got all information that is needed to verify everything (even though we might not be a member of the quorum)
-        // if any of this verification fails, we won't relay this message. This ensures that invalid messages are lost
-        // in the network. Nodes relaying such invalid messages to us are not punished as they might have not known
-        // all contributions. We only handle up to 2 commitments per member, so a DoS shouldn't be possible
-
-        if ((*quorumVvec)[0] != qc.quorumPublicKey) {
-            LogPrint(BCLog::QUORUM, "calculated quorum public key does not match");
+    // if any of the verification fails, we won't relay this message. This ensures that invalid messages are lost
+    // in the network. Nodes relaying such invalid messages to us are not punished as they might have not known
+    // all contributions. We only handle up to 2 commitments per member, so a DoS shouldn't be possible
+    auto verifiedIt = verifiedPrematureCommitments.find(hash);
+    if (verifiedIt != verifiedPrematureCommitments.end()) {
+        bool valid = verifiedIt->second;
+        verifiedPrematureCommitments.erase(verifiedIt);
+        if (!valid) {
             return;
         }
-        uint256 vvecHash = ::SerializeHash(*quorumVvec);
-        if (qc.quorumVvecHash != vvecHash) {
-            LogPrint(BCLog::QUORUM, "calculated quorum vvec hash does not match");
-            return;
-        }
-
-        CBLSPublicKey pubKeyShare = cache.BuildPubKeyShare(::SerializeHash(std::make_pair(memberIndexes, member->id)), quorumVvec, member->id);
-        if (!pubKeyShare.IsValid()) {
-            LogPrint(BCLog::QUORUM, "failed to calculate public key share");
-            return;
+    } else {
+        std::vector<uint16_t> memberIndexes;
+        std::vector<BLSVerificationVectorPtr> vvecs;
+        BLSSecretKeyVector skContributions;
+        BLSVerificationVectorPtr quorumVvec;
+        if (dkgManager.GetVerifiedContributions(params.type, pindexQuorum, qc.validMembers, memberIndexes, vvecs, skContributions)) {
+            quorumVvec = cache.BuildQuorumVerificationVector(::SerializeHash(memberIndexes), vvecs);
         }
 
-        if (!qc.quorumSig.VerifyInsecure(pubKeyShare, qc.GetSignHash())) {
-            LogPrint(BCLog::QUORUM, "failed to verify quorumSig");
+        if (quorumVvec == nullptr) {
+            LogPrint(BCLog::QUORUM, "failed to build quorum verification vector. skipping full verification");
+            // we might be the unlucky one who didn't receive all contributions, but we still have to relay
+            // the premature commitment as others might be luckier
+        } else if (!VerifyPrematureCommitment(qc, memberIndexes, quorumVvec)) {
             return;
         }
     }
@@ -269,6 +269,10 @@ private:
 
     std::vector<size_t> pendingContributionVerifications;
 
+    // filled by PreProcessMessages and consumed by ReceiveMessage, indexed by msg hash
+    std::map<uint256, std::pair<bool, CBLSSecretKey>> decryptedContributions;
+    std::map<uint256, bool> verifiedPrematureCommitments;
+
     // filled by ReceivePrematureCommitment and used by FinalizeCommitments
     std::set<uint256> validCommitments;
 
@@ -286,37 +290,47 @@ public:
      * 1. Execute local action (e.g. create/send own contributions)
      * 2. PreVerify incoming messages for this phase. Preverification means that everything from the message is checked
      *    that does not require too much resources for verification. This specifically excludes all CPU intensive BLS
-     *    operations.
+     *    operations. nBatched is the number of messages from the same member which already passed preverification in
+     *    the current batch, as the per member limits must count them before any BLS verification happens.
      * 3. CDKGSessionHandler will collect pre verified messages in batches and perform batched BLS signature verification
      *    on these.
-     * 4. ReceiveMessage is called for each pre verified message with a valid signature. ReceiveMessage is also
+     * 4. PreProcessMessages is called for the whole batch of messages with valid signatures. It performs the CPU
+     *    intensive parts of ReceiveMessage (e.g. decryption of contributions) in parallel on the BLS worker.
+     * 5. ReceiveMessage is called for each pre verified message with a valid signature. ReceiveMessage is also
      *    responsible for further verification of validity (e.g. validate vvecs and SK contributions).
      */
 
+    // Nothing to pre-process for complaints and justifications (the latter are verified in parallel in ReceiveMessage)
+    template<typename Message>
+    void PreProcessMessages(const std::vector<uint256>& hashes, const std::vector<std::pair<NodeId, std::shared_ptr<Message>>>& msgs) {}
+
     // Phase 1: contribution
     void Contribute(CDKGPendingMessages& pendingMessages);
     void SendContributions(CDKGPendingMessages& pendingMessages);
-    bool PreVerifyMessage(const uint256& hash, const CDKGContribution& qc, bool& retBan) const;
+    bool PreVerifyMessage(const uint256& hash, const CDKGContribution& qc, size_t nBatched, bool& retBan) const;
+    void PreProcessMessages(const std::vector<uint256>& hashes, const std::vector<std::pair<NodeId, std::shared_ptr<CDKGContribution>>>& msgs);
     void ReceiveMessage(const uint256& hash, const CDKGContribution& qc, bool& retBan);
     void VerifyPendingContributions();
 
     // Phase 2: complaint
     void VerifyAndComplain(CDKGPendingMessages& pendingMessages);
     void SendComplaint(CDKGPendingMessages& pendingMessages);
-    bool PreVerifyMessage(const uint256& hash, const CDKGComplaint& qc, bool& retBan) const;
+    bool PreVerifyMessage(const uint256& hash, const CDKGComplaint& qc, size_t nBatched, bool& retBan) const;
     void ReceiveMessage(const uint256& hash, const CDKGComplaint& qc, bool& retBan);
 
     // Phase 3: justification
     void VerifyAndJustify(CDKGPendingMessages& pendingMessages);
     void SendJustification(CDKGPendingMessages& pendingMessages, const std::set<uint256>& forMembers);
-    bool PreVerifyMessage(const uint256& hash, const CDKGJustification& qj, bool& retBan) const;
+    bool PreVerifyMessage(const uint256& hash, const CDKGJustification& qj, size_t nBatched, bool& retBan) const;
     void ReceiveMessage(const uint256& hash, const CDKGJustification& qj, bool& retBan);
 
     // Phase 4: commit
     void VerifyAndCommit(CDKGPendingMessages& pendingMessages);
     void SendCommitment(CDKGPendingMessages& pendingMessages);
-    bool PreVerifyMessage(const uint256& hash, const CDKGPrematureCommitment& qc, bool& retBan) const;
+    bool PreVerifyMessage(const uint256& hash, const CDKGPrematureCommitment& qc, size_t nBatched, bool& retBan) const;
+    void PreProcessMessages(const std::vector<uint256>& hashes, const std::vector<std::pair<NodeId, std::shared_ptr<CDKGPrematureCommitment>>>& msgs);
     void ReceiveMessage(const uint256& hash, const CDKGPrematureCommitment& qc, bool& retBan);
+    bool VerifyPrematureCommitment(const CDKGPrematureCommitment& qc, const std::vector<uint16_t>& memberIndexes, const BLSVerificationVectorPtr& quorumVvec);
 
     // Phase 5: aggregate/finalize
     std::vector<CFinalCommitment> FinalizeCommitments();
@@ -268,7 +268,7 @@ void CDKGSessionHandler::HandlePhase(QuorumPhase curPhase,
 
 // returns a set of NodeIds which sent invalid messages
 template<typename Message>
-std::set<NodeId> BatchVerifyMessageSigs(CDKGSession& session, const std::vector<std::pair<NodeId, std::shared_ptr<Message>>>& messages)
+std::set<NodeId> BatchVerifyMessageSigs(CDKGSession& session, CBLSWorker& blsWorker, const std::vector<std::pair<NodeId, std::shared_ptr<Message>>>& messages)
 {
     if (messages.empty()) {
         return {};
@@ -346,6 +346,9 @@ std::set<NodeId> BatchVerifyMessageSigs(CDKGSession& session, const std::vector<
         // different nodes, let's figure out who are the bad ones
     }
 
+    // verify all remaining messages individually, in parallel on the BLS worker
+    std::vector<std::pair<NodeId, std::future<bool>>> futures;
+    futures.reserve(messages.size());
     for (const auto& p : messages) {
         if (ret.count(p.first)) {
             continue;
@@ -353,8 +356,10 @@ std::set<NodeId> BatchVerifyMessageSigs(CDKGSession& session, const std::vector<
 
         const auto& msg = *p.second;
         auto member = session.GetMember(msg.proTxHash);
-        bool valid = msg.sig.VerifyInsecure(member->dmn->pdmnState->pubKeyOperator.Get(), msg.GetSignHash());
-        if (!valid) {
+        futures.emplace_back(p.first, blsWorker.AsyncVerifySig(msg.sig, member->dmn->pdmnState->pubKeyOperator.Get(), msg.GetSignHash()));
+    }
+    for (auto& p : futures) {
+        if (!p.second.get()) {
             ret.emplace(p.first);
         }
     }
@@ -362,7 +367,7 @@ std::set<NodeId> BatchVerifyMessageSigs(CDKGSession& session, const std::vector<
 }
 
 template<typename Message>
-bool ProcessPendingMessageBatch(CDKGSession& session, CDKGPendingMessages& pendingMessages, size_t maxCount)
+bool ProcessPendingMessageBatch(CDKGSession& session, CBLSWorker& blsWorker, CDKGPendingMessages& pendingMessages, size_t maxCount)
 {
     auto msgs = pendingMessages.PopAndDeserializeMessages<Message>(maxCount);
     if (msgs.empty()) {
@@ -374,6 +379,11 @@ bool ProcessPendingMessageBatch(CDKGSession& session, CDKGPendingMessages& pendi
     hashes.reserve(msgs.size());
     preverifiedMessages.reserve(msgs.size());
 
+    // The session only learns about a message in ReceiveMessage, so duplicates and the per member limits must be checked
+    // against the rest of the batch here, before any of it is queued for BLS verification
+    std::set<uint256> batchedHashes;
+    std::map<uint256, size_t> batchedPerMember;
+
     for (const auto& p : msgs) {
         if (!p.second) {
             LogPrintf("%s -- failed to deserialize message, peer=%d\n", __func__, p.first);
@@ -391,8 +401,13 @@ bool ProcessPendingMessageBatch(CDKGSession& session, CDKGPendingMessages& pendi
             g_connman->RemoveAskFor(hash);
         }
 
+        if (!batchedHashes.emplace(hash).second) {
+            LogPrint(BCLog::LLMQ, "%s -- skipping duplicate message, peer=%d\n", __func__, p.first);
+            continue;
+        }
+
         bool ban = false;
-        if (!session.PreVerifyMessage(hash, msg, ban)) {
+        if (!session.PreVerifyMessage(hash, msg, batchedPerMember[msg.proTxHash], ban)) {
             if (ban) {
                 LogPrintf("%s -- banning node due to failed preverification, peer=%d\n", __func__, p.first);
                 {
@@ -403,6 +418,7 @@ bool ProcessPendingMessageBatch(CDKGSession& session, CDKGPendingMessages& pendi
             LogPrintf("%s -- skipping message due to failed preverification, peer=%d\n", __func__, p.first);
             continue;
         }
+        batchedPerMember[msg.proTxHash]++;
         hashes.emplace_back(hash);
         preverifiedMessages.emplace_back(p);
     }
@@ -410,7 +426,7 @@ bool ProcessPendingMessageBatch(CDKGSession& session, CDKGPendingMessages& pendi
         return true;
     }
 
-    auto badNodes = BatchVerifyMessageSigs(session, preverifiedMessages);
+    auto badNodes = BatchVerifyMessageSigs(session, blsWorker, preverifiedMessages);
     if (!badNodes.empty()) {
         LOCK(cs_main);
         for (auto nodeId : badNodes) {
@@ -419,6 +435,19 @@ bool ProcessPendingMessageBatch(CDKGSession& session, CDKGPendingMessages& pendi
         }
     }
 
+    {
+        // let the session perform the CPU intensive parts of ReceiveMessage for the whole batch in parallel
+        std::vector<uint256> validHashes;
+        std::vector<std::pair<NodeId, std::shared_ptr<Message>>> validMessages;
+        for (size_t i = 0; i < preverifiedMessages.size(); i++) {
+            if (!badNodes.count(preverifiedMessages[i].first)) {
+                validHashes.emplace_back(hashes[i]);
+                validMessages.emplace_back(preverifiedMessages[i]);
+            }
+        }
+        session.PreProcessMessages(validHashes, validMessages);
+    }
+
     for (size_t i = 0; i < preverifiedMessages.size(); i++) {
         NodeId nodeId = preverifiedMessages[i].first;
         if (badNodes.count(nodeId)) {
@@ -506,7 +535,7 @@ void CDKGSessionHandler::HandleDKGRound()
         curSession->Contribute(pendingContributions);
     };
     auto fContributeWait = [this] {
-        return ProcessPendingMessageBatch<CDKGContribution>(*curSession, pendingContributions, 8);
+        return ProcessPendingMessageBatch<CDKGContribution>(*curSession, blsWorker, pendingContributions, 32);
     };
     HandlePhase(QuorumPhase_Contribute, QuorumPhase_Complain, curQuorumHash, 0.05, fContributeStart, fContributeWait);
 
@@ -515,7 +544,7 @@ void CDKGSessionHandler::HandleDKGRound()
         curSession->VerifyAndComplain(pendingComplaints);
     };
     auto fComplainWait = [this] {
-        return ProcessPendingMessageBatch<CDKGComplaint>(*curSession, pendingComplaints, 8);
+        return ProcessPendingMessageBatch<CDKGComplaint>(*curSession, blsWorker, pendingComplaints, 8);
     };
     HandlePhase(QuorumPhase_Complain, QuorumPhase_Justify, curQuorumHash, 0.05, fComplainStart, fComplainWait);
 
@@ -524,7 +553,7 @@ void CDKGSessionHandler::HandleDKGRound()
         curSession->VerifyAndJustify(pendingJustifications);
     };
     auto fJustifyWait = [this] {
-        return ProcessPendingMessageBatch<CDKGJustification>(*curSession, pendingJustifications, 8);
+        return ProcessPendingMessageBatch<CDKGJustification>(*curSession, blsWorker, pendingJustifications, 8);
     };
     HandlePhase(QuorumPhase_Justify, QuorumPhase_Commit, curQuorumHash, 0.05, fJustifyStart, fJustifyWait);
 
@@ -533,7 +562,7 @@ void CDKGSessionHandler::HandleDKGRound()
         curSession->VerifyAndCommit(pendingPrematureCommitments);
     };
     auto fCommitWait = [this] {
-        return ProcessPendingMessageBatch<CDKGPrematureCommitment>(*curSession, pendingPrematureCommitments, 8);
+        return ProcessPendingMessageBatch<CDKGPrematureCommitment>(*curSession, blsWorker, pendingPrematureCommitments, 32);
     };
     HandlePhase(QuorumPhase_Commit, QuorumPhase_Finalize, curQuorumHash, 0.1, fCommitStart, fCommitWait);
 
@@ -5,6 +5,7 @@
 #ifndef DASH_QUORUMS_INIT_H
 #define DASH_QUORUMS_INIT_H
 
+class CBLSWorker;
 class CDBWrapper;
 class CEvoDB;
 class CScheduler;
@@ -12,6 +13,8 @@ class CScheduler;
 namespace llmq
 {
 
+extern CBLSWorker* blsWorker;
+
 // If true, we will connect to all new quorums and watch their communication
 static const bool DEFAULT_WATCH_QUORUMS = false;
 
@@ -3,10 +3,12 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <llmq/quorums_chainlocks.h>
+#include <llmq/quorums_init.h>
 #include <llmq/quorums_instantsend.h>
 #include <llmq/quorums_utils.h>
 
 #include <bls/bls_batchverifier.h>
+#include <bls/bls_worker.h>
 #include <chainparams.h>
 #include <coins.h>
 #include <txmempool.h>
@@ -292,7 +294,7 @@ std::vector<uint256> CInstantSendDb::GetInstantSendLocksByParent(const uint256&
     return result;
 }
 
-std::vector<uint256> CInstantSendDb::RemoveChainedInstantSendLocks(const uint256& islockHash, const uint256& txid, int nHeight)
+std::vector<uint256> CInstantSendDb::RemoveChainedInstantSendLocks(const uint256& islockHash, const uint256& txid, int nHeight, std::vector<uint256>& retRemovedTxids)
 {
     std::vector<uint256> result;
 
@@ -314,6 +316,7 @@ std::vector<uint256> CInstantSendDb::RemoveChainedInstantSendLocks(const uint256
             RemoveInstantSendLock(batch, childIslockHash, childIsLock);
             WriteInstantSendLockArchived(batch, childIslockHash, nHeight);
             result.emplace_back(childIslockHash);
+            retRemovedTxids.emplace_back(childIsLock->txid);
 
             if (added.emplace(childIsLock->txid).second) {
                 stack.emplace_back(childIsLock->txid);
@@ -324,6 +327,7 @@ std::vector<uint256> CInstantSendDb::RemoveChainedInstantSendLocks(const uint256
     RemoveInstantSendLock(batch, islockHash, nullptr);
     WriteInstantSendLockArchived(batch, islockHash, nHeight);
     result.emplace_back(islockHash);
+    retRemovedTxids.emplace_back(txid);
 
     db.WriteBatch(batch);
 
@@ -751,48 +755,99 @@ bool CInstantSendManager::ProcessPendingInstantSendLocks()
     auto quorums2 = quorumSigningManager->GetActiveQuorumSet(llmqType, tipHeight - 1);
     bool quorumsRotated = quorums1 != quorums2;
 
-    if (quorumsRotated) {
-        // first check against the current active set and don't ban
-        auto badISLocks = ProcessPendingInstantSendLocks(tipHeight, pend, false);
-        if (!badISLocks.empty()) {
-            LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- detected LLMQ active set rotation, redoing verification on old active set\n", __func__);
-
-            // filter out valid IS locks from "pend"
-            for (auto it = pend.begin(); it != pend.end(); ) {
-                if (!badISLocks.count(it->first)) {
-                    it = pend.erase(it);
-                } else {
-                    ++it;
+    // Select the signing quorums for both active sets only once per request id. Many ISLOCKs share the same request id
+    // (e.g. the same lock relayed by multiple peers), so this also avoids re-hashing the quorum scores for each of them
+    std::unordered_map<uint256, std::pair<CQuorumCPtr, CQuorumCPtr>, StaticSaltedHasher> quorumsById;
+    std::unordered_map<uint256, CQuorumCPtr, StaticSaltedHasher> selectedQuorums1;
+    std::unordered_map<uint256, CQuorumCPtr, StaticSaltedHasher> selectedQuorums2;
+    for (const auto& p : pend) {
+        auto id = p.second.second.GetRequestId();
+        auto it = quorumsById.find(id);
+        if (it == quorumsById.end()) {
+            auto quorum1 = CSigningManager::SelectQuorumForSigning(llmqType, quorums1, id);
+            auto quorum2 = quorumsRotated ? CSigningManager::SelectQuorumForSigning(llmqType, quorums2, id) : quorum1;
+            if (!quorum1) {
+                // should not happen, but if one fails to select, all others will also fail to select
+                return true;
+            }
+            it = quorumsById.emplace(id, std::make_pair(std::move(quorum1), std::move(quorum2))).first;
+        }
+        selectedQuorums1.emplace(p.first, it->second.first);
+        if (it->second.second && it->second.second != it->second.first) {
+            // only locks which would be signed by a different quorum in the previous active set need re-verification
+            selectedQuorums2.emplace(p.first, it->second.second);
+        }
+    }
+
+    // first check against the current active set
+    auto badISLocks = ProcessPendingInstantSendLocks(pend, selectedQuorums1);
+
+    if (quorumsRotated && !badISLocks.empty()) {
+        decltype(pend) pend2;
+        for (const auto& hash : badISLocks) {
+            if (selectedQuorums2.count(hash)) {
+                pend2.emplace(hash, pend.at(hash));
+            }
+        }
+        if (!pend2.empty()) {
+            LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- detected LLMQ active set rotation, redoing verification of %d ISLOCKs on old active set\n", __func__,
+                     pend2.size());
+
+            // now check against the previous active set and only treat locks as bad when this also fails
+            auto badISLocks2 = ProcessPendingInstantSendLocks(pend2, selectedQuorums2);
+            for (const auto& p : pend2) {
+                if (!badISLocks2.count(p.first)) {
+                    badISLocks.erase(p.first);
                 }
             }
-            // now check against the previous active set and perform banning if this fails
-            ProcessPendingInstantSendLocks(tipHeight - 1, pend, true);
         }
-    } else {
-        ProcessPendingInstantSendLocks(tipHeight, pend, true);
+    }
+
+    if (!badISLocks.empty()) {
+        std::set<NodeId> badSources;
+        for (const auto& hash : badISLocks) {
+            badSources.emplace(pend.at(hash).first);
+        }
+
+        LOCK(cs_main);
+        for (auto& nodeId : badSources) {
+            // Let's not be too harsh, as the peer might simply be unlucky and might have sent us an old lock which
+            // does not validate anymore due to changed quorums
+            Misbehaving(nodeId, 20);
+        }
     }
 
     return true;
 }
 
-std::unordered_set<uint256> CInstantSendManager::ProcessPendingInstantSendLocks(int signHeight, const std::unordered_map<uint256, std::pair<NodeId, CInstantSendLock>>& pend, bool ban)
+std::unordered_set<uint256> CInstantSendManager::ProcessPendingInstantSendLocks(const std::unordered_map<uint256, std::pair<NodeId, CInstantSendLock>>& pend,
+                                                                                const std::unordered_map<uint256, CQuorumCPtr, StaticSaltedHasher>& selectedQuorums)
 {
     auto llmqType = Params().GetConsensus().llmqTypeInstantSend;
 
-    CBLSBatchVerifier<NodeId, uint256> batchVerifier(false, true, 8);
+    // Sub-batches are verified independently from each other on the BLS worker pool
+    static const size_t SUB_BATCH_SIZE = 8;
+
+    std::list<CBLSBatchVerifier<NodeId, uint256>> batchVerifiers;
+    size_t curBatchSize = SUB_BATCH_SIZE;
     std::unordered_map<uint256, std::pair<CQuorumCPtr, CRecoveredSig>> recSigs;
 
+    std::unordered_set<uint256> badISLocks;
+    std::set<NodeId> badSources;
+
     for (const auto& p : pend) {
         auto& hash = p.first;
         auto nodeId = p.second.first;
         auto& islock = p.second.second;
 
-        if (batchVerifier.badSources.count(nodeId)) {
+        if (badSources.count(nodeId)) {
+            badISLocks.emplace(hash);
             continue;
         }
 
         if (!islock.sig.Get().IsValid()) {
-            batchVerifier.badSources.emplace(nodeId);
+            badSources.emplace(nodeId);
+            badISLocks.emplace(hash);
             continue;
         }
 
@@ -803,13 +858,14 @@ std::unordered_set<uint256> CInstantSendManager::ProcessPendingInstantSendLocks(
             continue;
         }
 
-        auto quorum = quorumSigningManager->SelectQuorumForSigning(llmqType, signHeight, id);
-        if (!quorum) {
-            // should not happen, but if one fails to select, all others will also fail to select
-            return {};
-        }
+        auto quorum = selectedQuorums.at(hash);
         uint256 signHash = CLLMQUtils::BuildSignHash(llmqType, quorum->qc.quorumHash, id, islock.txid);
-        batchVerifier.PushMessage(nodeId, hash, signHash, islock.sig.Get(), quorum->qc.quorumPublicKey);
+        if (curBatchSize >= SUB_BATCH_SIZE) {
+            batchVerifiers.emplace_back(false, true);
+            curBatchSize = 0;
+        }
+        batchVerifiers.back().PushMessage(nodeId, hash, signHash, islock.sig.Get(), quorum->qc.quorumPublicKey);
+        curBatchSize++;
 
         // We can reconstruct the CRecoveredSig objects from the islock and pass it to the signing manager, which
         // avoids unnecessary double-verification of the signature. We however only do this when verification here
@@ -827,27 +883,27 @@ std::unordered_set<uint256> CInstantSendManager::ProcessPendingInstantSendLocks(
         }
     }
 
-    batchVerifier.Verify();
-
-    std::unordered_set<uint256> badISLocks;
+    std::vector<std::function<void()>> jobs;
+    jobs.reserve(batchVerifiers.size());
+    for (auto& batchVerifier : batchVerifiers) {
+        jobs.emplace_back([&batchVerifier]() {
+            batchVerifier.Verify();
+        });
+    }
+    blsWorker->RunJobsAndWait(jobs);
 
-    if (ban && !batchVerifier.badSources.empty()) {
-        LOCK(cs_main);
-        for (auto& nodeId : batchVerifier.badSources) {
-            // Let's not be too harsh, as the peer might simply be unlucky and might have sent us an old lock which
-            // does not validate anymore due to changed quorums
-            Misbehaving(nodeId, 20);
-        }
+    for (const auto& batchVerifier : batchVerifiers) {
+        badISLocks.insert(batchVerifier.badMessages.begin(), batchVerifier.badMessages.end());
     }
+
     for (const auto& p : pend) {
         auto& hash = p.first;
         auto nodeId = p.second.first;
         auto& islock = p.second.second;
 
-        if (batchVerifier.badMessages.count(hash)) {
+        if (badISLocks.count(hash)) {
             LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- txid=%s, islock=%s: invalid sig in islock, peer=%d\n", __func__,
                      islock.txid.ToString(), hash.ToString(), nodeId);
-            badISLocks.emplace(hash);
             continue;
         }
 
@@ -938,6 +994,8 @@ void CInstantSendManager::ProcessInstantSendLock(NodeId from, const uint256& has
         TruncateRecoveredSigsForInputs(islock);
     }
 
+    chainLocksHandler->NotifyTxLocked(islock.txid);
+
     CInv inv(MSG_ISLOCK, hash);
     if (tx != nullptr) {
         g_connman->RelayInvFiltered(inv, *tx, LLMQS_PROTO_VERSION);
@@ -1169,6 +1227,9 @@ void CInstantSendManager::HandleFullyConfirmedBlock(const CBlockIndex* pindex)
         // And we don't need the recovered sig for the ISLOCK anymore, as the block in which it got mined is considered
         // fully confirmed now
         quorumSigningManager->TruncateRecoveredSig(consensusParams.llmqTypeInstantSend, islock->GetRequestId());
+
+        // IsLocked doesn't know about this TX anymore, keep the ChainLocks handler in sync with that
+        chainLocksHandler->NotifyTxUnlocked(islock->txid);
     }
 
     // Find all previously unlocked TXs that got locked by this fully confirmed (ChainLock) block and remove them
@@ -1315,11 +1376,19 @@ void CInstantSendManager::RemoveChainLockConflictingLock(const uint256& islockHa
         tipHeight = ::ChainActive().Height();
     }
 
-    LOCK(cs);
-    auto removedIslocks = db.RemoveChainedInstantSendLocks(islockHash, islock.txid, tipHeight);
-    for (auto& h : removedIslocks) {
-        LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- txid=%s, islock=%s: removed (child) ISLOCK %s\n", __func__,
-                  islock.txid.ToString(), islockHash.ToString(), h.ToString());
+    std::vector<uint256> removedTxids;
+    {
+        LOCK(cs);
+        auto removedIslocks = db.RemoveChainedInstantSendLocks(islockHash, islock.txid, tipHeight, removedTxids);
+        for (auto& h : removedIslocks) {
+            LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- txid=%s, islock=%s: removed (child) ISLOCK %s\n", __func__,
+                      islock.txid.ToString(), islockHash.ToString(), h.ToString());
+        }
+    }
+
+    // these TXs are not ixlocked anymore, so blocks including them must not be ChainLocked before they are old enough
+    for (auto& txid : removedTxids) {
+        chainLocksHandler->NotifyTxUnlocked(txid);
     }
 }
 
@@ -69,7 +69,7 @@ public:
     CInstantSendLockPtr GetInstantSendLockByInput(const COutPoint& outpoint);
 
     std::vector<uint256> GetInstantSendLocksByParent(const uint256& parent);
-    std::vector<uint256> RemoveChainedInstantSendLocks(const uint256& islockHash, const uint256& txid, int nHeight);
+    std::vector<uint256> RemoveChainedInstantSendLocks(const uint256& islockHash, const uint256& txid, int nHeight, std::vector<uint256>& retRemovedTxids);
 };
 
 class CInstantSendManager : public CRecoveredSigsListener
@@ -137,7 +137,8 @@ public:
     void ProcessMessageInstantSendLock(CNode* pfrom, const CInstantSendLock& islock, CConnman& connman);
     bool PreVerifyInstantSendLock(NodeId nodeId, const CInstantSendLock& islock, bool& retBan);
     bool ProcessPendingInstantSendLocks();
-    std::unordered_set<uint256> ProcessPendingInstantSendLocks(int signHeight, const std::unordered_map<uint256, std::pair<NodeId, CInstantSendLock>>& pend, bool ban);
+    std::unordered_set<uint256> ProcessPendingInstantSendLocks(const std::unordered_map<uint256, std::pair<NodeId, CInstantSendLock>>& pend,
+                                                               const std::unordered_map<uint256, CQuorumCPtr, StaticSaltedHasher>& selectedQuorums);
     void ProcessInstantSendLock(NodeId from, const uint256& hash, const CInstantSendLock& islock);
     void UpdateWalletTransaction(const CTransactionRef& tx, const CInstantSendLock& islock);
 
@@ -36,20 +36,181 @@ UniValue CRecoveredSig::ToJson() const
     return ret;
 }
 
+bool CRecoveredSigsFilter::Bucket::IsFull() const
+{
+    // beyond this, the false positive rate of (1/3)^HASH_FUNCS quickly gets worse
+    return bitsSet * 3 > bits.size() * 64;
+}
+
+void CRecoveredSigsFilter::ExpectEntry(uint32_t writeTime)
+{
+    windows[writeTime / WINDOW_TIME_SPAN].expectedEntries++;
+}
+
+void CRecoveredSigsFilter::Add(uint32_t writeTime, Consensus::LLMQType llmqType, const uint256& id, const uint256& signHash, const uint256& hash)
+{
+    auto& window = windows[writeTime / WINDOW_TIME_SPAN];
+    if (window.buckets.empty() || window.buckets.back().IsFull()) {
+        // Expect as many entries as the busiest window got so far. When a bucket of this window is already full, this is
+        // at least the number of entries in it, so the buckets of a window grow geometrically
+        size_t expectedEntries = window.expectedEntries;
+        for (const auto& p : windows) {
+            expectedEntries = std::max(expectedEntries, p.second.entries);
+        }
+        window.buckets.emplace_back(NewBucket(expectedEntries * KEYS_PER_RECSIG, MAX_BUCKET_BITS));
+    }
+    auto& bucket = window.buckets.back();
+    Insert(bucket, CalcHash(id, KEY_ID | (uint8_t)llmqType));
+    Insert(bucket, CalcHash(signHash, KEY_SESSION));
+    Insert(bucket, CalcHash(hash, KEY_HASH));
+    window.entries++;
+}
+
+void CRecoveredSigsFilter::AddPersistentHash(const uint256& hash)
+{
+    if (persistentBucket.bits.empty()) {
+        persistentBucket = NewPersistentBucket(0);
+    }
+    AddPersistentHash(persistentBucket, hash);
+    if (fRebuildingPersistent) {
+        pendingPersistentHashes.emplace_back(hash);
+    }
+}
+
+void CRecoveredSigsFilter::Cleanup(uint32_t endTime)
+{
+    for (auto it = windows.begin(); it != windows.end(); ) {
+        if ((it->first + 1) * WINDOW_TIME_SPAN > (int64_t)endTime) {
+            break;
+        }
+        it = windows.erase(it);
+    }
+}
+
+bool CRecoveredSigsFilter::BeginPersistentRebuild()
+{
+    if (fRebuildingPersistent || !persistentBucket.IsFull()) {
+        return false;
+    }
+    fRebuildingPersistent = true;
+    return true;
+}
+
+CRecoveredSigsFilter::Bucket CRecoveredSigsFilter::NewPersistentBucket(size_t expectedCount) const
+{
+    // not capped, as there is no way to rotate this bucket
+    return NewBucket(expectedCount, std::numeric_limits<size_t>::max());
+}
+
+void CRecoveredSigsFilter::AddPersistentHash(Bucket& bucket, const uint256& hash) const
+{
+    Insert(bucket, CalcHash(hash, KEY_HASH));
+}
+
+void CRecoveredSigsFilter::FinishPersistentRebuild(Bucket&& bucket)
+{
+    // the DB scan might have missed these
+    for (const auto& hash : pendingPersistentHashes) {
+        AddPersistentHash(bucket, hash);
+    }
+    persistentBucket = std::move(bucket);
+    pendingPersistentHashes.clear();
+    fRebuildingPersistent = false;
+}
+
+bool CRecoveredSigsFilter::MayHaveId(Consensus::LLMQType llmqType, const uint256& id) const
+{
+    return ContainsAny(CalcHash(id, KEY_ID | (uint8_t)llmqType), false);
+}
+
+bool CRecoveredSigsFilter::MayHaveSession(const uint256& signHash) const
+{
+    return ContainsAny(CalcHash(signHash, KEY_SESSION), false);
+}
+
+bool CRecoveredSigsFilter::MayHaveHash(const uint256& hash) const
+{
+    return ContainsAny(CalcHash(hash, KEY_HASH), true);
+}
+
+CRecoveredSigsFilter::Bucket CRecoveredSigsFilter::NewBucket(size_t expectedKeys, size_t maxBits)
+{
+    size_t bits = MIN_BUCKET_BITS;
+    while (bits < maxBits && bits < expectedKeys * BITS_PER_KEY) {
+        bits <<= 1;
+    }
+    Bucket bucket;
+    bucket.bits.resize(bits / 64);
+    return bucket;
+}
+
+uint64_t CRecoveredSigsFilter::CalcHash(const uint256& v, uint32_t keyType) const
+{
+    return SipHashUint256Extra(salt.k0, salt.k1, v, keyType);
+}
+
+// Uses double hashing (h1 + i * h2) to derive HASH_FUNCS bit positions from a single 64bit hash
+void CRecoveredSigsFilter::Insert(Bucket& bucket, uint64_t h)
+{
+    size_t bucketBits = bucket.bits.size() * 64;
+    uint32_t h1 = (uint32_t)h;
+    uint32_t h2 = (uint32_t)(h >> 32) | 1;
+    for (int i = 0; i < HASH_FUNCS; i++) {
+        size_t bit = (h1 + i * h2) % bucketBits;
+        uint64_t mask = (uint64_t)1 << (bit & 63);
+        if (!(bucket.bits[bit >> 6] & mask)) {
+            bucket.bits[bit >> 6] |= mask;
+            bucket.bitsSet++;
+        }
+    }
+}
+
+bool CRecoveredSigsFilter::Contains(const Bucket& bucket, uint64_t h)
+{
+    if (bucket.bits.empty()) {
+        return false;
+    }
+    size_t bucketBits = bucket.bits.size() * 64;
+    uint32_t h1 = (uint32_t)h;
+    uint32_t h2 = (uint32_t)(h >> 32) | 1;
+    for (int i = 0; i < HASH_FUNCS; i++) {
+        size_t bit = (h1 + i * h2) % bucketBits;
+        if (!(bucket.bits[bit >> 6] & ((uint64_t)1 << (bit & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CRecoveredSigsFilter::ContainsAny(uint64_t h, bool checkPersistent) const
+{
+    // newest windows and buckets first, as recent recovered sigs are the most likely ones to be queried
+    for (auto it = windows.rbegin(); it != windows.rend(); ++it) {
+        for (auto it2 = it->second.buckets.rbegin(); it2 != it->second.buckets.rend(); ++it2) {
+            if (Contains(*it2, h)) {
+                return true;
+            }
+        }
+    }
+    return checkPersistent && Contains(persistentBucket, h);
+}
+
+//////////////////
+
 CRecoveredSigsDb::CRecoveredSigsDb(CDBWrapper& _db) :
     db(_db)
 {
     if (Params().NetworkIDString() == CBaseChainParams::TESTNET) {
         // TODO this can be completely removed after some time (when we're pretty sure the conversion has been run on most testnet MNs)
-        if (db.Exists(std::string("rs_upgraded"))) {
-            return;
-        }
+        if (!db.Exists(std::string("rs_upgraded"))) {
+            ConvertInvalidTimeKeys();
+            AddVoteTimeKeys();
 
-        ConvertInvalidTimeKeys();
-        AddVoteTimeKeys();
-
-        db.Write(std::string("rs_upgraded"), (Consensus::LLMQType)1);
+            db.Write(std::string("rs_upgraded"), (Consensus::LLMQType)1);
+        }
     }
+
+    LoadFilter();
 }
 
 // This converts time values in "rs_t" from host endiannes to big endiannes, which is required to have proper ordering of the keys
@@ -125,8 +286,152 @@ void CRecoveredSigsDb::AddVoteTimeKeys()
     LogPrint(BCLog::QUORUM, "CRecoveredSigsDb::%s -- added %d rs_vt entries\n", __func__, cnt);
 }
 
+// Fills the negative lookup filter with all recovered sigs found in the DB
+void CRecoveredSigsDb::LoadFilter()
+{
+    int64_t nStart = GetTimeMillis();
+
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+
+    LOCK(cs);
+
+    // Count the recovered sigs per write time window first, so that every window starts with a bucket of the right size
+    auto start0 = std::make_tuple(std::string("rs_t"), (uint32_t)0, (Consensus::LLMQType)0, uint256());
+    pcursor->Seek(start0);
+    while (pcursor->Valid()) {
+        decltype(start0) k;
+        if (!pcursor->GetKey(k) || std::get<0>(k) != "rs_t") {
+            break;
+        }
+        filter.ExpectEntry(be32toh(std::get<1>(k)));
+        pcursor->Next();
+    }
+
+    auto start = std::make_tuple(std::string("rs_r"), (Consensus::LLMQType)0, uint256());
+    pcursor->Seek(start);
+
+    // "rs_r" keys come in pairs. The shorter key holds the recSig and the longer one (which has the msgHash appended)
+    // holds the write time
+    std::unordered_set<uint256, StaticSaltedHasher> knownHashes;
+    CRecoveredSig recSig;
+    bool haveRecSig = false;
+    uint32_t curTime = GetAdjustedTime();
+
+    while (pcursor->Valid()) {
+        std::tuple<std::string, Consensus::LLMQType, uint256, uint256> k;
+        if (pcursor->GetKey(k)) {
+            if (std::get<0>(k) != "rs_r") {
+                break;
+            }
+            uint32_t writeTime;
+            if (pcursor->GetValueSize() != sizeof(uint32_t) || !pcursor->GetValue(writeTime)) {
+                // TODO remove this in a future version (when we stop supporting upgrades from < 0.14.1)
+                writeTime = curTime;
+            }
+            if (haveRecSig && recSig.llmqType == std::get<1>(k) && recSig.id == std::get<2>(k)) {
+                filter.Add(writeTime, recSig.llmqType, recSig.id, CLLMQUtils::BuildSignHash(recSig), recSig.GetHash());
+                knownHashes.emplace(recSig.GetHash());
+            }
+            haveRecSig = false;
+        } else {
+            std::tuple<std::string, Consensus::LLMQType, uint256> k2;
+            if (!pcursor->GetKey(k2) || std::get<0>(k2) != "rs_r") {
+                break;
+            }
+            haveRecSig = pcursor->GetValue(recSig);
+        }
+        pcursor->Next();
+    }
+
+    // The "rs_h" keys of truncated recovered sigs are not accompanied by any "rs_r" keys. They are collected first, so
+    // that the persistent bucket can be sized for all of them
+    std::vector<uint256> truncatedHashes;
+    auto start2 = std::make_tuple(std::string("rs_h"), uint256());
+    pcursor->Seek(start2);
+    while (pcursor->Valid()) {
+        decltype(start2) k;
+        if (!pcursor->GetKey(k) || std::get<0>(k) != "rs_h") {
+            break;
+        }
+        if (!knownHashes.count(std::get<1>(k))) {
+            truncatedHashes.emplace_back(std::get<1>(k));
+        }
+        pcursor->Next();
+    }
+
+    auto persistentBucket = filter.NewPersistentBucket(truncatedHashes.size());
+    for (const auto& hash : truncatedHashes) {
+        filter.AddPersistentHash(persistentBucket, hash);
+    }
+    filter.FinishPersistentRebuild(std::move(persistentBucket));
+
+    LogPrint(BCLog::LLMQ, "CRecoveredSigsDb::%s -- loaded %d recovered sigs and %d truncated recovered sigs, time=%d\n", __func__,
+             knownHashes.size(), truncatedHashes.size(), GetTimeMillis() - nStart);
+}
+
+// The persistent bucket of the filter only ever fills up, as the "rs_h" keys of truncated recovered sigs are never deleted.
+// Refill it from the DB with a size that matches the current number of "rs_h" keys, so that the false positive rate of
+// MayHaveHash stays low. The DB is scanned without holding cs, lookups keep using the old bucket until the new one is
+// swapped in. Must only be called after filter.BeginPersistentRebuild() returned true
+void CRecoveredSigsDb::RebuildPersistentFilter()
+{
+    AssertLockNotHeld(cs);
+
+    int64_t nStart = GetTimeMillis();
+
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    auto start = std::make_tuple(std::string("rs_h"), uint256());
+
+    // the number of "rs_h" keys is an upper bound of the number of truncated recovered sigs
+    size_t totalCount = 0;
+    pcursor->Seek(start);
+    while (pcursor->Valid()) {
+        decltype(start) k;
+        if (!pcursor->GetKey(k) || std::get<0>(k) != "rs_h") {
+            break;
+        }
+        totalCount++;
+        pcursor->Next();
+    }
+
+    auto bucket = filter.NewPersistentBucket(totalCount);
+
+    size_t truncatedCount = 0;
+    pcursor->Seek(start);
+    while (pcursor->Valid()) {
+        decltype(start) k;
+        if (!pcursor->GetKey(k) || std::get<0>(k) != "rs_h") {
+            break;
+        }
+        // recovered sigs which still have their "rs_r" key are covered by the time windows. Sigs truncated while this
+        // scan runs are added to the new bucket by FinishPersistentRebuild
+        std::pair<Consensus::LLMQType, uint256> v;
+        if (!pcursor->GetValue(v) || !db.Exists(std::make_tuple(std::string("rs_r"), v.first, v.second))) {
+            filter.AddPersistentHash(bucket, std::get<1>(k));
+            truncatedCount++;
+        }
+        pcursor->Next();
+    }
+    pcursor.reset();
+
+    {
+        LOCK(cs);
+        filter.FinishPersistentRebuild(std::move(bucket));
+    }
+
+    LogPrint(BCLog::LLMQ, "CRecoveredSigsDb::%s -- rebuilt persistent filter with %d truncated recovered sigs, time=%d\n", __func__,
+             truncatedCount, GetTimeMillis() - nStart);
+}
+
 bool CRecoveredSigsDb::HasRecoveredSig(Consensus::LLMQType llmqType, const uint256& id, const uint256& msgHash)
 {
+    {
+        LOCK(cs);
+        if (!filter.MayHaveId(llmqType, id)) {
+            return false;
+        }
+    }
+
     auto k = std::make_tuple(std::string("rs_r"), llmqType, id, msgHash);
     return db.Exists(k);
 }
@@ -140,6 +445,9 @@ bool CRecoveredSigsDb::HasRecoveredSigForId(Consensus::LLMQType llmqType, const
         if (hasSigForIdCache.get(cacheKey, ret)) {
             return ret;
         }
+        if (!filter.MayHaveId(llmqType, id)) {
+            return false;
+        }
     }
 
 
@@ -159,6 +467,9 @@ bool CRecoveredSigsDb::HasRecoveredSigForSession(const uint256& signHash)
         if (hasSigForSessionCache.get(signHash, ret)) {
             return ret;
         }
+        if (!filter.MayHaveSession(signHash)) {
+            return false;
+        }
     }
 
     auto k = std::make_tuple(std::string("rs_s"), signHash);
@@ -177,6 +488,9 @@ bool CRecoveredSigsDb::HasRecoveredSigForHash(const uint256& hash)
         if (hasSigForHashCache.get(hash, ret)) {
             return ret;
         }
+        if (!filter.MayHaveHash(hash)) {
+            return false;
+        }
     }
 
     auto k = std::make_tuple(std::string("rs_h"), hash);
@@ -247,11 +561,15 @@ void CRecoveredSigsDb::WriteRecoveredSig(const llmq::CRecoveredSig& recSig)
     auto k5 = std::make_tuple(std::string("rs_t"), (uint32_t)htobe32(curTime), recSig.llmqType, recSig.id);
     batch.Write(k5, (Consensus::LLMQType)1);
 
+    {
+        // add to the filter before writing, so that concurrent lookups never see a false negative
+        LOCK(cs);
+        filter.Add(curTime, recSig.llmqType, recSig.id, signHash, recSig.GetHash());
+    }
+
     db.WriteBatch(batch);
 
     {
-        int64_t t = GetTimeMillis();
-
         LOCK(cs);
         hasSigForIdCache.insert(std::make_pair((Consensus::LLMQType)recSig.llmqType, recSig.id), true);
         hasSigForSessionCache.insert(signHash, true);
@@ -278,6 +596,9 @@ void CRecoveredSigsDb::RemoveRecoveredSig(CDBBatch& batch, Consensus::LLMQType l
     batch.Erase(k2);
     if (deleteHashKey) {
         batch.Erase(k3);
+    } else {
+        // the "rs_h" key stays forever, so it must also stay in the filter when the bucket of the recSig expires
+        filter.AddPersistentHash(recSig.GetHash());
     }
     batch.Erase(k4);
 
@@ -311,10 +632,17 @@ void CRecoveredSigsDb::RemoveRecoveredSig(Consensus::LLMQType llmqType, const ui
 // This will leave the byHash key in-place so that HasRecoveredSigForHash still returns true
 void CRecoveredSigsDb::TruncateRecoveredSig(Consensus::LLMQType llmqType, const uint256& id)
 {
-    LOCK(cs);
-    CDBBatch batch(db);
-    RemoveRecoveredSig(batch, llmqType, id, false, false);
-    db.WriteBatch(batch);
+    bool rebuildFilter;
+    {
+        LOCK(cs);
+        CDBBatch batch(db);
+        RemoveRecoveredSig(batch, llmqType, id, false, false);
+        db.WriteBatch(batch);
+        rebuildFilter = filter.BeginPersistentRebuild();
+    }
+    if (rebuildFilter) {
+        RebuildPersistentFilter();
+    }
 }
 
 void CRecoveredSigsDb::CleanupOldRecoveredSigs(int64_t maxAge)
@@ -346,6 +674,8 @@ void CRecoveredSigsDb::CleanupOldRecoveredSigs(int64_t maxAge)
     pcursor.reset();
 
     if (toDelete.empty()) {
+        LOCK(cs);
+        filter.Cleanup(endTime);
         return;
     }
 
@@ -368,6 +698,11 @@ void CRecoveredSigsDb::CleanupOldRecoveredSigs(int64_t maxAge)
 
     db.WriteBatch(batch);
 
+    {
+        LOCK(cs);
+        filter.Cleanup(endTime);
+    }
+
     LogPrint(BCLog::LLMQ, "CRecoveredSigsDb::%d -- deleted %d entries\n", __func__, toDelete.size());
 }
 
@@ -887,7 +1222,11 @@ std::vector<CQuorumCPtr> CSigningManager::GetActiveQuorumSet(Consensus::LLMQType
 
 CQuorumCPtr CSigningManager::SelectQuorumForSigning(Consensus::LLMQType llmqType, int signHeight, const uint256& selectionHash)
 {
-    auto quorums = GetActiveQuorumSet(llmqType, signHeight);
+    return SelectQuorumForSigning(llmqType, GetActiveQuorumSet(llmqType, signHeight), selectionHash);
+}
+
+CQuorumCPtr CSigningManager::SelectQuorumForSigning(Consensus::LLMQType llmqType, const std::vector<CQuorumCPtr>& quorums, const uint256& selectionHash)
+{
     if (quorums.empty()) {
         return nullptr;
     }
@@ -13,6 +13,7 @@
 #include <univalue.h>
 #include <unordered_lru_cache.h>
 
+#include <map>
 #include <unordered_map>
 
 namespace llmq
@@ -61,12 +62,90 @@ public:
     UniValue ToJson() const;
 };
 
+// Memory bounded filter which answers negative lookups for recovered sigs without touching the DB. Entries are put into
+// windows by their write time, so that whole windows can be dropped once CleanupOldRecoveredSigs has deleted all the
+// recovered sigs they cover. A miss is authoritative while a hit still requires a lookup in the caches or the DB.
+// A window consists of one or more buckets. New buckets are sized for the number of entries expected in a window, and
+// once a third of the bits of a bucket are set, further entries go into a new one. This keeps the false positive rate of
+// every bucket bounded, no matter how many recovered sigs arrive.
+// Hashes of truncated recovered sigs are kept in a separate bucket which never expires, as their "rs_h" keys are never
+// removed from the DB. Once it is full, it is rebuilt from the DB with a matching size (see
+// CRecoveredSigsDb::RebuildPersistentFilter)
+class CRecoveredSigsFilter
+{
+public:
+    struct Bucket {
+        std::vector<uint64_t> bits;
+        size_t bitsSet{0};
+
+        bool IsFull() const;
+    };
+
+private:
+    static const int64_t WINDOW_TIME_SPAN = 60 * 60 * 24;
+    static const int HASH_FUNCS = 4;
+    // ~22% of the bits are set at the expected number of keys, a bucket is full at a third
+    static const size_t BITS_PER_KEY = 16;
+    static const size_t MIN_BUCKET_BITS = 1 << 16; // 8kB
+    static const size_t MAX_BUCKET_BITS = 1 << 24; // 2MB, only for the time windows which can rotate
+    // id, session and hash
+    static const size_t KEYS_PER_RECSIG = 3;
+
+    enum KeyType : uint32_t {
+        KEY_ID = 1 << 8,
+        KEY_SESSION = 2 << 8,
+        KEY_HASH = 3 << 8,
+    };
+
+    struct Window {
+        std::vector<Bucket> buckets;
+        size_t entries{0};
+        // number of entries announced by ExpectEntry, used to size the first bucket
+        size_t expectedEntries{0};
+    };
+
+    SaltedHasherBase salt;
+    std::map<int64_t, Window> windows; // by window index (writeTime / WINDOW_TIME_SPAN)
+    Bucket persistentBucket;
+    // hashes added while the persistent bucket is rebuilt, they are added to the new bucket as well
+    bool fRebuildingPersistent{false};
+    std::vector<uint256> pendingPersistentHashes;
+
+public:
+    // Announces a recovered sig which is going to be added, so that its window starts with a bucket of the right size
+    void ExpectEntry(uint32_t writeTime);
+    void Add(uint32_t writeTime, Consensus::LLMQType llmqType, const uint256& id, const uint256& signHash, const uint256& hash);
+    void AddPersistentHash(const uint256& hash);
+    // Drops all windows which only cover write times older than endTime
+    void Cleanup(uint32_t endTime);
+
+    // Returns true if the persistent bucket is full and no other rebuild is running. The caller must then fill a bucket
+    // created by NewPersistentBucket and pass it to FinishPersistentRebuild
+    bool BeginPersistentRebuild();
+    // Creating and filling the new bucket only reads the salt, so it can be done without the lock guarding the filter
+    Bucket NewPersistentBucket(size_t expectedCount) const;
+    void AddPersistentHash(Bucket& bucket, const uint256& hash) const;
+    void FinishPersistentRebuild(Bucket&& bucket);
+
+    bool MayHaveId(Consensus::LLMQType llmqType, const uint256& id) const;
+    bool MayHaveSession(const uint256& signHash) const;
+    bool MayHaveHash(const uint256& hash) const;
+
+private:
+    static Bucket NewBucket(size_t expectedKeys, size_t maxBits);
+    uint64_t CalcHash(const uint256& v, uint32_t keyType) const;
+    static void Insert(Bucket& bucket, uint64_t h);
+    static bool Contains(const Bucket& bucket, uint64_t h);
+    bool ContainsAny(uint64_t h, bool checkPersistent) const;
+};
+
 class CRecoveredSigsDb
 {
 private:
     CDBWrapper& db;
 
     CCriticalSection cs;
+    CRecoveredSigsFilter filter;
     unordered_lru_cache<std::pair<Consensus::LLMQType, uint256>, bool, StaticSaltedHasher, 30000> hasSigForIdCache;
     unordered_lru_cache<uint256, bool, StaticSaltedHasher, 30000> hasSigForSessionCache;
     unordered_lru_cache<uint256, bool, StaticSaltedHasher, 30000> hasSigForHashCache;
@@ -76,6 +155,7 @@ public:
 
     void ConvertInvalidTimeKeys();
     void AddVoteTimeKeys();
+    void LoadFilter();
 
     bool HasRecoveredSig(Consensus::LLMQType llmqType, const uint256& id, const uint256& msgHash);
     bool HasRecoveredSigForId(Consensus::LLMQType llmqType, const uint256& id);
@@ -99,6 +179,7 @@ public:
 private:
     bool ReadRecoveredSig(Consensus::LLMQType llmqType, const uint256& id, CRecoveredSig& ret);
     void RemoveRecoveredSig(CDBBatch& batch, Consensus::LLMQType llmqType, const uint256& id, bool deleteHashKey, bool deleteTimeKey);
+    void RebuildPersistentFilter();
 };
 
 class CRecoveredSigsListener
@@ -180,6 +261,9 @@ public:
 
     std::vector<CQuorumCPtr> GetActiveQuorumSet(Consensus::LLMQType llmqType, int signHeight);
     CQuorumCPtr SelectQuorumForSigning(Consensus::LLMQType llmqType, int signHeight, const uint256& selectionHash);
+    // Same as above, but selects from an already retrieved active quorum set. Use this when selecting for many request
+    // ids at once to avoid scanning quorums for every single selection
+    static CQuorumCPtr SelectQuorumForSigning(Consensus::LLMQType llmqType, const std::vector<CQuorumCPtr>& quorums, const uint256& selectionHash);
 
     // Verifies a recovered sig that was signed while the chain tip was at signedAtTip
     bool VerifyRecoveredSig(Consensus::LLMQType llmqType, int signedAtHeight, const uint256& id, const uint256& msgHash, const CBLSSignature& sig);
@@ -40,6 +40,12 @@
 #include <poll.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
 #ifdef USE_UPNP
 #include <miniupnpc/miniupnpc.h>
 #include <miniupnpc/miniwget.h>
@@ -84,6 +90,9 @@ enum BindFlags {
 // The sleep time needs to be small to avoid new sockets stalling
 static const uint64_t SELECT_TIMEOUT_MILLISECONDS = 50;
 
+/** Size of the buffer a single recv() reads into, a typical socket buffer is 8K-64K */
+static const int SOCKET_RECV_BUFFER_SIZE = 0x10000;
+
 const std::string NET_MESSAGE_COMMAND_OTHER = "*other*";
 
 constexpr const CConnman::CFullyConnectedOnly CConnman::FullyConnectedOnly;
@@ -754,9 +763,11 @@ size_t CConnman::SocketSendData(CNode *pnode) const EXCLUSIVE_LOCKS_REQUIRED(pno
                 it++;
             } else {
                 // could not send full message; stop sending more
+                pnode->fCanSendData = false;
                 break;
             }
         } else {
+            pnode->fCanSendData = false;
             if (nBytes < 0) {
                 // error
                 int nErr = WSAGetLastError();
@@ -1070,6 +1081,7 @@ void CConnman::AcceptConnection(const ListenSocket& hListenSocket) {
 
     LogPrint(BCLog::NET, "connection from %s accepted\n", addr.ToString());
 
+    RegisterEvents(pnode);
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
@@ -1105,6 +1117,7 @@ void CConnman::DisconnectNodes()
                 pnode->grantMasternodeOutbound.Release();
 
                 // close socket and cleanup
+                UnregisterEvents(pnode);
                 pnode->CloseSocketDisconnect();
 
                 // hold in disconnected pool until all refs are released
@@ -1232,8 +1245,139 @@ bool CConnman::GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &s
     return !recv_set.empty() || !send_set.empty() || !error_set.empty();
 }
 
+#ifdef USE_EPOLL
+bool CConnman::InitSocketEventsEPoll()
+{
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd == -1) {
+        LogPrintf("epoll_create1 failed: %s\n", NetworkErrorString(errno));
+        return false;
+    }
+    m_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeup_fd == -1) {
+        LogPrintf("eventfd failed: %s\n", NetworkErrorString(errno));
+        return false;
+    }
+
+    // The wakeup fd and the listening sockets are level-triggered, nodes are registered as they connect.
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wakeup_fd, &event) != 0) {
+        LogPrintf("epoll_ctl failed for the wakeup fd: %s\n", NetworkErrorString(errno));
+        return false;
+    }
+    for (ListenSocket& hListenSocket : vhListenSocket) {
+        event.events = EPOLLIN;
+        event.data.ptr = &hListenSocket;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, hListenSocket.socket, &event) != 0) {
+            LogPrintf("epoll_ctl failed for a listening socket: %s\n", NetworkErrorString(errno));
+            return false;
+        }
+    }
+    return true;
+}
+
+void CConnman::SocketEventsEPoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+{
+    // Nodes are registered once and edge-triggered, so only sockets whose state changed are
+    // returned. The readiness of each node is kept in fHasRecvData and fCanSendData until
+    // SocketHandler() has drained it. Don't sleep if it could not drain everything last time.
+    static constexpr int EPOLL_MAX_EVENTS = 256;
+    epoll_event events[EPOLL_MAX_EVENTS];
+    int nEvents = epoll_wait(m_epoll_fd, events, EPOLL_MAX_EVENTS, m_epoll_more_work ? 0 : (int)SELECT_TIMEOUT_MILLISECONDS);
+
+    if (interruptNet) return;
+
+    if (nEvents < 0) {
+        if (errno != EINTR) {
+            LogPrintf("epoll_wait error %s\n", NetworkErrorString(errno));
+            interruptNet.sleep_for(std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS));
+        }
+        return;
+    }
+
+    for (int i = 0; i < nEvents; i++) {
+        const epoll_event& event = events[i];
+        if (event.data.ptr == nullptr) {
+            uint64_t nWakeups;
+            if (read(m_wakeup_fd, &nWakeups, sizeof(nWakeups)) != sizeof(nWakeups)) {
+                LogPrint(BCLog::NET, "failed to read from the wakeup fd\n");
+            }
+            continue;
+        }
+        bool fListenSocket = false;
+        for (const ListenSocket& hListenSocket : vhListenSocket) {
+            if (event.data.ptr == &hListenSocket) {
+                recv_set.insert(hListenSocket.socket);
+                fListenSocket = true;
+                break;
+            }
+        }
+        if (fListenSocket) continue;
+
+        // Nodes are only deleted by this thread, and closing a socket removes its registration.
+        CNode* pnode = static_cast<CNode*>(event.data.ptr);
+        if (event.events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) {
+            // Errors and hangups show up as the result of the next recv()
+            pnode->fHasRecvData = true;
+        }
+        if (event.events & EPOLLOUT) {
+            LOCK(pnode->cs_vSend);
+            pnode->fCanSendData = true;
+        }
+    }
+}
+#endif
+
+void CConnman::RegisterEvents(CNode* pnode)
+{
+#ifdef USE_EPOLL
+    if (socketEventsMode != SocketEventsMode::EPoll || m_epoll_fd == -1) return;
+
+    LOCK(pnode->cs_hSocket);
+    if (pnode->hSocket == INVALID_SOCKET) return;
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = pnode;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, pnode->hSocket, &event) != 0) {
+        LogPrintf("epoll_ctl failed for peer=%d: %s\n", pnode->GetId(), NetworkErrorString(errno));
+        pnode->fDisconnect = true;
+    }
+#endif
+}
+
+void CConnman::UnregisterEvents(CNode* pnode)
+{
+#ifdef USE_EPOLL
+    if (socketEventsMode != SocketEventsMode::EPoll || m_epoll_fd == -1) return;
+
+    // A socket that was already closed has been removed from the epoll set by the kernel
+    LOCK(pnode->cs_hSocket);
+    if (pnode->hSocket == INVALID_SOCKET) return;
+
+    epoll_event event{};
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, pnode->hSocket, &event) != 0) {
+        LogPrint(BCLog::NET, "epoll_ctl failed to remove peer=%d: %s\n", pnode->GetId(), NetworkErrorString(errno));
+    }
+#endif
+}
+
+void CConnman::WakeSelect()
+{
+#ifdef USE_EPOLL
+    if (m_wakeup_fd == -1) return;
+
+    uint64_t nOne = 1;
+    if (write(m_wakeup_fd, &nOne, sizeof(nOne)) != sizeof(nOne)) {
+        LogPrint(BCLog::NET, "failed to write to the wakeup fd\n");
+    }
+#endif
+}
+
 #ifdef USE_POLL
-void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+void CConnman::SocketEventsPoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
 {
     std::set<SOCKET> recv_select_set, send_select_set, error_select_set;
     if (!GenerateSelectSet(recv_select_set, send_select_set, error_select_set)) {
@@ -1274,8 +1418,9 @@ void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_s
         if (pollfd_entry.revents & (POLLERR|POLLHUP)) error_set.insert(pollfd_entry.fd);
     }
 }
-#else
-void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+#endif
+
+void CConnman::SocketEventsSelect(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
 {
     std::set<SOCKET> recv_select_set, send_select_set, error_select_set;
     if (!GenerateSelectSet(recv_select_set, send_select_set, error_select_set)) {
@@ -1348,7 +1493,79 @@ void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_s
         }
     }
 }
+
+void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+{
+#ifdef USE_EPOLL
+    if (socketEventsMode == SocketEventsMode::EPoll) {
+        SocketEventsEPoll(recv_set, send_set, error_set);
+        return;
+    }
+#endif
+#ifdef USE_POLL
+    if (socketEventsMode == SocketEventsMode::Poll) {
+        SocketEventsPoll(recv_set, send_set, error_set);
+        return;
+    }
 #endif
+    SocketEventsSelect(recv_set, send_set, error_set);
+}
+
+int CConnman::SocketRecvData(CNode* pnode)
+{
+    char pchBuf[SOCKET_RECV_BUFFER_SIZE];
+    int nBytes = 0;
+    {
+        LOCK(pnode->cs_hSocket);
+        if (pnode->hSocket == INVALID_SOCKET)
+            return 0;
+        nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+    }
+    if (nBytes > 0)
+    {
+        bool notify = false;
+        if (!pnode->ReceiveMsgBytes(pchBuf, nBytes, notify))
+            pnode->CloseSocketDisconnect();
+        RecordBytesRecv(nBytes);
+        if (notify) {
+            size_t nSizeAdded = 0;
+            auto it(pnode->vRecvMsg.begin());
+            for (; it != pnode->vRecvMsg.end(); ++it) {
+                if (!it->complete())
+                    break;
+                nSizeAdded += it->vRecv.size() + CMessageHeader::HEADER_SIZE;
+            }
+            {
+                LOCK(pnode->cs_vProcessMsg);
+                pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
+                pnode->nProcessQueueSize += nSizeAdded;
+                pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
+            }
+            WakeMessageHandler();
+        }
+    }
+    else if (nBytes == 0)
+    {
+        // socket closed gracefully
+        if (!pnode->fDisconnect) {
+            LogPrint(BCLog::NET, "socket closed for peer=%d\n", pnode->GetId());
+        }
+        pnode->CloseSocketDisconnect();
+    }
+    else if (nBytes < 0)
+    {
+        // error
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
+        {
+            if (!pnode->fDisconnect) {
+                LogPrint(BCLog::NET, "socket recv error for peer=%d: %s\n", pnode->GetId(), NetworkErrorString(nErr));
+            }
+            pnode->CloseSocketDisconnect();
+        }
+    }
+    return nBytes;
+}
 
 void CConnman::SocketHandler()
 {
@@ -1378,6 +1595,9 @@ void CConnman::SocketHandler()
         for (CNode* pnode : vNodesCopy)
             pnode->AddRef();
     }
+#ifdef USE_EPOLL
+    m_epoll_more_work = false;
+#endif
     for (CNode* pnode : vNodesCopy)
     {
         if (interruptNet)
@@ -1389,7 +1609,16 @@ void CConnman::SocketHandler()
         bool recvSet = false;
         bool sendSet = false;
         bool errorSet = false;
-        {
+        if (socketEventsMode == SocketEventsMode::EPoll) {
+            // Same policy as GenerateSelectSet: drain the send buffer before receiving more
+            bool fPendingSend;
+            {
+                LOCK(pnode->cs_vSend);
+                fPendingSend = !pnode->vSendMsg.empty();
+                sendSet = fPendingSend && pnode->fCanSendData;
+            }
+            recvSet = !fPendingSend && pnode->fHasRecvData && !pnode->fPauseRecv;
+        } else {
             LOCK(pnode->cs_hSocket);
             if (pnode->hSocket == INVALID_SOCKET)
                 continue;
@@ -1399,57 +1628,10 @@ void CConnman::SocketHandler()
         }
         if (recvSet || errorSet)
         {
-            // typical socket buffer is 8K-64K
-            char pchBuf[0x10000];
-            int nBytes = 0;
-            {
-                LOCK(pnode->cs_hSocket);
-                if (pnode->hSocket == INVALID_SOCKET)
-                    continue;
-                nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-            }
-            if (nBytes > 0)
-            {
-                bool notify = false;
-                if (!pnode->ReceiveMsgBytes(pchBuf, nBytes, notify))
-                    pnode->CloseSocketDisconnect();
-                RecordBytesRecv(nBytes);
-                if (notify) {
-                    size_t nSizeAdded = 0;
-                    auto it(pnode->vRecvMsg.begin());
-                    for (; it != pnode->vRecvMsg.end(); ++it) {
-                        if (!it->complete())
-                            break;
-                        nSizeAdded += it->vRecv.size() + CMessageHeader::HEADER_SIZE;
-                    }
-                    {
-                        LOCK(pnode->cs_vProcessMsg);
-                        pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
-                        pnode->nProcessQueueSize += nSizeAdded;
-                        pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
-                    }
-                    WakeMessageHandler();
-                }
-            }
-            else if (nBytes == 0)
-            {
-                // socket closed gracefully
-                if (!pnode->fDisconnect) {
-                    LogPrint(BCLog::NET, "socket closed for peer=%d\n", pnode->GetId());
-                }
-                pnode->CloseSocketDisconnect();
-            }
-            else if (nBytes < 0)
-            {
-                // error
-                int nErr = WSAGetLastError();
-                if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
-                {
-                    if (!pnode->fDisconnect) {
-                        LogPrint(BCLog::NET, "socket recv error for peer=%d: %s\n", pnode->GetId(), NetworkErrorString(nErr));
-                    }
-                    pnode->CloseSocketDisconnect();
-                }
+            int nBytes = SocketRecvData(pnode);
+            if (nBytes < SOCKET_RECV_BUFFER_SIZE) {
+                // A short read drained the socket, the next edge sets fHasRecvData again
+                pnode->fHasRecvData = false;
             }
         }
 
@@ -1465,6 +1647,15 @@ void CConnman::SocketHandler()
             }
         }
 
+#ifdef USE_EPOLL
+        if (socketEventsMode == SocketEventsMode::EPoll) {
+            LOCK(pnode->cs_vSend);
+            if (pnode->vSendMsg.empty() ? (pnode->fHasRecvData && !pnode->fPauseRecv) : pnode->fCanSendData) {
+                m_epoll_more_work = true;
+            }
+        }
+#endif
+
         InactivityCheck(pnode);
     }
     {
@@ -2124,6 +2315,7 @@ void CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
         pnode->fMasternode = true;
 
     m_msgproc->InitializeNode(pnode);
+    RegisterEvents(pnode);
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
@@ -2391,6 +2583,17 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         return false;
     }
 
+#ifdef USE_EPOLL
+    if (socketEventsMode == SocketEventsMode::EPoll && !InitSocketEventsEPoll()) {
+        if (clientInterface) {
+            clientInterface->ThreadSafeMessageBox(
+                _("Failed to initialize the epoll socket events mode. Use -socketevents to select another mode.").translated,
+                "", CClientUIInterface::MSG_ERROR);
+        }
+        return false;
+    }
+#endif
+
     for (const auto& strDest : connOptions.vSeedNodes) {
         AddOneShot(strDest);
     }
@@ -2499,6 +2702,7 @@ void CConnman::Interrupt()
     condMsgProc.notify_all();
 
     interruptNet();
+    WakeSelect();
     InterruptSocks5(true);
 
     if (semOutbound) {
@@ -2560,6 +2764,16 @@ void CConnman::Stop()
     vNodes.clear();
     vNodesDisconnected.clear();
     vhListenSocket.clear();
+#ifdef USE_EPOLL
+    if (m_wakeup_fd != -1) {
+        close(m_wakeup_fd);
+        m_wakeup_fd = -1;
+    }
+    if (m_epoll_fd != -1) {
+        close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
+#endif
     semOutbound.reset();
     semAddnode.reset();
     semMasternodeOutbound.reset();
@@ -3104,6 +3318,7 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg, bool allowOpti
     CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, serializedHeader, 0, hdr};
 
     size_t nBytesSent = 0;
+    bool fWakeSelect = false;
     {
         LOCK(pnode->cs_vSend);
         bool optimisticSend(pnode->vSendMsg.empty());
@@ -3119,11 +3334,17 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg, bool allowOpti
             pnode->vSendMsg.push_back(std::move(msg.data));
 
         // If write queue empty, attempt "optimistic write"
-        if (optimisticSend == true)
+        if (optimisticSend == true) {
             nBytesSent = SocketSendData(pnode);
+        } else if (pnode->fCanSendData) {
+            // The socket handler has not drained the writable socket yet, don't let it wait for the timeout
+            fWakeSelect = true;
+        }
     }
     if (nBytesSent)
         RecordBytesSent(nBytesSent);
+    if (fWakeSelect)
+        WakeSelect();
 }
 
 bool CConnman::ForNode(const CService& addr, std::function<bool(const CNode* pnode)> cond, std::function<bool(CNode* pnode)> func)
@@ -3213,3 +3434,46 @@ uint64_t CConnman::CalculateKeyedNetGroup(const CAddress& ad) const
 
     return GetDeterministicRandomizer(RANDOMIZER_ID_NETGROUP).Write(vchNetGroup.data(), vchNetGroup.size()).Finalize();
 }
+
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode)
+{
+    if (str == "select") {
+        mode = SocketEventsMode::Select;
+        return true;
+    }
+#ifdef USE_POLL
+    if (str == "poll") {
+        mode = SocketEventsMode::Poll;
+        return true;
+    }
+#endif
+#ifdef USE_EPOLL
+    if (str == "epoll") {
+        mode = SocketEventsMode::EPoll;
+        return true;
+    }
+#endif
+    return false;
+}
+
+std::string SocketEventsModeToString(SocketEventsMode mode)
+{
+    switch (mode) {
+    case SocketEventsMode::Select: return "select";
+    case SocketEventsMode::Poll: return "poll";
+    case SocketEventsMode::EPoll: return "epoll";
+    } // no default case, so the compiler can warn about missing cases
+    assert(false);
+}
+
+std::string GetSupportedSocketEventsModes()
+{
+    std::string strModes = "select";
+#ifdef USE_POLL
+    strModes += ", poll";
+#endif
+#ifdef USE_EPOLL
+    strModes += ", epoll";
+#endif
+    return strModes;
+}
@@ -98,6 +98,21 @@ static const uint64_t DEFAULT_MAX_UPLOAD_TARGET = 0;
 static const uint64_t MAX_UPLOAD_TIMEFRAME = 60 * 60 * 24;
 /** Default for blocks only*/
 static const bool DEFAULT_BLOCKSONLY = false;
+
+/** How the socket handler thread waits for socket events, see -socketevents */
+enum class SocketEventsMode {
+    Select,
+    Poll,
+    EPoll,
+};
+/** -socketevents default */
+#if defined(USE_EPOLL)
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SocketEventsMode::EPoll;
+#elif defined(USE_POLL)
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SocketEventsMode::Poll;
+#else
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SocketEventsMode::Select;
+#endif
 /** -peertimeout default */
 static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
 
@@ -168,6 +183,7 @@ public:
         bool m_use_addrman_outgoing = true;
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
+        SocketEventsMode socketEventsMode = DEFAULT_SOCKETEVENTS;
     };
 
     void Init(const Options& connOptions) {
@@ -186,6 +202,7 @@ public:
         nSendBufferMaxSize = connOptions.nSendBufferMaxSize;
         nReceiveFloodSize = connOptions.nReceiveFloodSize;
         m_peer_connect_timeout = connOptions.m_peer_connect_timeout;
+        socketEventsMode = connOptions.socketEventsMode;
         {
             LOCK(cs_totalBytesSent);
             nMaxOutboundTimeframe = connOptions.nMaxOutboundTimeframe;
@@ -262,6 +279,9 @@ public:
 
     void PushMessage(CNode* pnode, CSerializedNetMsg&& msg, bool allowOptimisticSend = false); // LOLOL we just drop the boolean
 
+    /** Interrupt the socket handler thread's wait for socket events (epoll mode only). */
+    void WakeSelect();
+
     template<typename Condition, typename Callable>
     bool ForEachNodeContinueIf(const Condition& cond, Callable&& func)
     {
@@ -459,7 +479,20 @@ private:
     void NotifyNumConnectionsChanged();
     void InactivityCheck(CNode *pnode);
     bool GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#ifdef USE_EPOLL
+    bool InitSocketEventsEPoll();
+    void SocketEventsEPoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#endif
+#ifdef USE_POLL
+    void SocketEventsPoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#endif
+    void SocketEventsSelect(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
     void SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+    /** Register a new node's socket with the socket events backend, before it is added to vNodes. */
+    void RegisterEvents(CNode* pnode);
+    void UnregisterEvents(CNode* pnode);
+    /** Receive once from a node's socket. Returns the result of recv(). */
+    int SocketRecvData(CNode* pnode);
     void SocketHandler();
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
@@ -577,6 +610,16 @@ private:
 
     CThreadInterrupt interruptNet;
 
+    SocketEventsMode socketEventsMode{DEFAULT_SOCKETEVENTS};
+#ifdef USE_EPOLL
+    /** epoll instance holding persistent, edge-triggered registrations of all node sockets */
+    int m_epoll_fd{-1};
+    /** eventfd used by WakeSelect() */
+    int m_wakeup_fd{-1};
+    /** Whether the last SocketHandler() iteration left readable or writable nodes unserviced */
+    bool m_epoll_more_work{false};
+#endif
+
     std::thread threadDNSAddressSeed;
     std::thread threadSocketHandler;
     std::thread threadOpenAddedConnections;
@@ -593,6 +636,13 @@ private:
 
     friend struct CConnmanTest;
 };
+
+/** Parse a -socketevents mode. Returns false if the mode is unknown or not supported on this platform. */
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode);
+std::string SocketEventsModeToString(SocketEventsMode mode);
+/** Comma-separated list of the -socketevents modes supported on this platform */
+std::string GetSupportedSocketEventsModes();
+
 extern std::unique_ptr<CConnman> g_connman;
 extern std::unique_ptr<BanMan> g_banman;
 void Discover();
@@ -839,6 +889,11 @@ public:
     const uint64_t nKeyedNetGroup;
     std::atomic_bool fPauseRecv{false};
     std::atomic_bool fPauseSend{false};
+    //! Whether the socket may have data to receive, used by the epoll socket events mode. Only
+    //! accessed by the socket handler thread.
+    bool fHasRecvData{false};
+    //! Whether the socket may accept more data to send, used by the epoll socket events mode
+    bool fCanSendData GUARDED_BY(cs_vSend){false};
 
 protected:
     mapMsgCmdSize mapSendBytesPerMsgCmd;
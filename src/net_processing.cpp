@@ -25,11 +25,13 @@
 #include <primitives/transaction.h>
 #include <random.h>
 #include <reverse_iterator.h>
+#include <saltedhasher.h>
 #include <scheduler.h>
 #include <shutdown.h>
 #include <tinyformat.h>
 #include <txdb.h>
 #include <txmempool.h>
+#include <unordered_lru_cache.h>
 #include <util/system.h>
 #include <util/strencodings.h>
 #include <validation.h>
@@ -1140,8 +1142,141 @@ static bool BlockRequestAllowed(const CBlockIndex* pindex, const Consensus::Para
         (GetBlockProofEquivalentTime(*pindexBestHeader, *pindex, *pindexBestHeader, consensusParams) < STALE_RELAY_AGE_LIMIT);
 }
 
-PeerLogicValidation::PeerLogicValidation(CConnman* connmanIn, BanMan* banman, CScheduler &scheduler, bool enable_bip61)
+/** Process a message of the masternode subsystems (PrivateSend, sporks, sync, governance, MNAUTH, LLMQ). */
+static void ProcessExtensionMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, CConnman* connman)
+{
+#ifdef ENABLE_WALLET
+    privateSendClient.ProcessMessage(pfrom, strCommand, vRecv, *connman);
+#endif // ENABLE_WALLET
+    privateSendServer.ProcessMessage(pfrom, strCommand, vRecv, *connman);
+    sporkManager.ProcessSpork(pfrom, strCommand, vRecv, *connman);
+    masternodeSync.ProcessMessage(pfrom, strCommand, vRecv);
+    governance.ProcessMessage(pfrom, strCommand, vRecv, *connman);
+    CMNAuth::ProcessMessage(pfrom, strCommand, vRecv, *connman);
+    llmq::quorumBlockProcessor->ProcessMessage(pfrom, strCommand, vRecv, *connman);
+    llmq::quorumDKGSessionManager->ProcessMessage(pfrom, strCommand, vRecv, *connman);
+    llmq::quorumSigSharesManager->ProcessMessage(pfrom, strCommand, vRecv, *connman);
+    llmq::quorumSigningManager->ProcessMessage(pfrom, strCommand, vRecv, *connman);
+    llmq::chainLocksHandler->ProcessMessage(pfrom, strCommand, vRecv, *connman);
+    llmq::quorumInstantSendManager->ProcessMessage(pfrom, strCommand, vRecv, *connman);
+}
+
+ExtensionMessageQueue::ExtensionMessageQueue(CConnman* connman, int n_threads, Handler handler) :
+    m_connman(connman), m_handler(std::move(handler))
+{
+    m_queues.resize(n_threads);
+    // TraceThread keeps a pointer to the name, so all names are created before any thread starts.
+    for (int i = 0; i < n_threads; ++i) {
+        m_thread_names.push_back(strprintf("mnmsg.%d", i));
+    }
+    for (size_t i = 0; i < m_thread_names.size(); ++i) {
+        m_threads.emplace_back(&TraceThread<std::function<void()>>, m_thread_names[i].c_str(),
+                               std::bind(&ExtensionMessageQueue::ThreadProcess, this, i));
+    }
+}
+
+bool ExtensionMessageQueue::Push(CNode* pfrom, const std::string& strCommand, CDataStream&& vRecv)
+{
+    {
+        LOCK(m_mutex);
+        if (m_stop) return false;
+        const size_t nSize = vRecv.size();
+        m_peer_bytes[pfrom->GetId()] += nSize + CMessageHeader::HEADER_SIZE;
+        m_queues[pfrom->GetId() % m_queues.size()].push_back(Job{pfrom->AddRef(), strCommand, std::move(vRecv), nSize});
+    }
+    m_cv.notify_all();
+    return true;
+}
+
+size_t ExtensionMessageQueue::GetQueuedBytes(NodeId nodeid)
+{
+    LOCK(m_mutex);
+    auto it = m_peer_bytes.find(nodeid);
+    return it != m_peer_bytes.end() ? it->second : 0;
+}
+
+bool ExtensionMessageQueue::IsBacklogged(NodeId nodeid)
+{
+    return GetQueuedBytes(nodeid) > MAX_MN_MSG_QUEUE_BYTES;
+}
+
+bool ExtensionMessageQueue::Release(const Job& job)
+{
+    auto it = m_peer_bytes.find(job.pfrom->GetId());
+    assert(it != m_peer_bytes.end());
+    const bool was_backlogged = it->second > MAX_MN_MSG_QUEUE_BYTES;
+    it->second -= job.nSize + CMessageHeader::HEADER_SIZE;
+    const bool is_backlogged = it->second > MAX_MN_MSG_QUEUE_BYTES;
+    if (it->second == 0) m_peer_bytes.erase(it);
+    job.pfrom->Release();
+    return was_backlogged && !is_backlogged;
+}
+
+void ExtensionMessageQueue::ThreadProcess(size_t index)
+{
+    while (true) {
+        std::deque<Job> jobs;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_queues[index].empty(); });
+            if (m_stop) return;
+            jobs.swap(m_queues[index]);
+        }
+
+        bool stop = false;
+        for (Job& job : jobs) {
+            if (!stop && !job.pfrom->fDisconnect) {
+                try {
+                    m_handler(job.pfrom, job.strCommand, job.vRecv);
+                } catch (const std::exception& e) {
+                    LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' (%s) caught\n", __func__, SanitizeString(job.strCommand), job.nSize, e.what(), typeid(e).name());
+                } catch (...) {
+                    LogPrint(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n", __func__, SanitizeString(job.strCommand), job.nSize);
+                }
+            }
+            bool wake;
+            {
+                LOCK(m_mutex);
+                wake = Release(job);
+                stop = m_stop;
+            }
+            if (wake) {
+                // The message handler skips backlogged peers, let it pick this one up again.
+                m_connman->WakeMessageHandler();
+            }
+        }
+    }
+}
+
+void ExtensionMessageQueue::Stop()
+{
+    {
+        LOCK(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+
+    LOCK(m_mutex);
+    for (auto& queue : m_queues) {
+        for (const Job& job : queue) {
+            Release(job);
+        }
+        queue.clear();
+    }
+}
+
+PeerLogicValidation::PeerLogicValidation(CConnman* connmanIn, BanMan* banman, CScheduler &scheduler, bool enable_bip61, int n_mn_msg_threads)
     : connman(connmanIn), m_banman(banman), m_stale_tip_check_time(0), m_enable_bip61(enable_bip61) {
+    if (n_mn_msg_threads > 0) {
+        m_extension_queue.reset(new ExtensionMessageQueue(connman, n_mn_msg_threads,
+            [connmanIn](CNode* pfrom, const std::string& strCommand, CDataStream& vRecv) {
+                ProcessExtensionMessage(pfrom, strCommand, vRecv, connmanIn);
+            }));
+    }
     // Initialize global variables that cannot be constructed at startup.
     recentRejects.reset(new CRollingBloomFilter(120000, 0.000001));
     const Consensus::Params& consensusParams = Params().GetConsensus();
@@ -1149,6 +1284,16 @@ PeerLogicValidation::PeerLogicValidation(CConnman* connmanIn, BanMan* banman, CS
     scheduler.scheduleEvery(std::bind(&PeerLogicValidation::CheckForStaleTipAndEvictPeers, this, consensusParams), EXTRA_PEER_CHECK_INTERVAL * 1000);
 }
 
+PeerLogicValidation::~PeerLogicValidation()
+{
+    StopExtensionMessageThreads();
+}
+
+void PeerLogicValidation::StopExtensionMessageThreads()
+{
+    if (m_extension_queue) m_extension_queue->Stop();
+}
+
 void PeerLogicValidation::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex, const std::vector<CTransactionRef>& vtxConflicted) {
     LOCK(g_cs_orphans);
 
@@ -1188,6 +1333,36 @@ static std::shared_ptr<const CBlockHeaderAndShortTxIDs> most_recent_compact_bloc
 static uint256 most_recent_block_hash GUARDED_BY(cs_most_recent_block);
 static bool fWitnessesPresentInMostRecentCompactBlock GUARDED_BY(cs_most_recent_block);
 
+/** Number of serialized blocks kept after being served from disk */
+static constexpr size_t RECENT_RAW_BLOCKS_CACHE_SIZE = 8;
+// Blocks recently served from disk, so that peers requesting the same blocks (masternodes
+// syncing, several peers catching up) share one read. Protected by cs_recent_raw_blocks.
+static CCriticalSection cs_recent_raw_blocks;
+static unordered_lru_cache<uint256, std::shared_ptr<const std::vector<uint8_t>>, StaticSaltedHasher, RECENT_RAW_BLOCKS_CACHE_SIZE> recent_raw_blocks GUARDED_BY(cs_recent_raw_blocks);
+
+/** Read a block as stored on disk, or take it from the recently served blocks. */
+static std::shared_ptr<const std::vector<uint8_t>> ReadRawBlockCached(const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& message_start)
+{
+    const uint256 hash = pindex->GetBlockHash();
+    std::shared_ptr<const std::vector<uint8_t>> block_data;
+    {
+        LOCK(cs_recent_raw_blocks);
+        if (recent_raw_blocks.get(hash, block_data)) {
+            return block_data;
+        }
+    }
+
+    auto read_data = std::make_shared<std::vector<uint8_t>>();
+    if (!ReadRawBlockFromDisk(*read_data, pindex, message_start)) {
+        return nullptr;
+    }
+    block_data = std::move(read_data);
+
+    LOCK(cs_recent_raw_blocks);
+    recent_raw_blocks.insert(hash, block_data);
+    return block_data;
+}
+
 /**
  * Maintain state about the best-seen block and fast-announce a compact block
  * to compatible peers.
@@ -1507,14 +1682,18 @@ void static ProcessGetBlockData(CNode* pfrom, const Consensus::Params& consensus
         std::shared_ptr<const CBlock> pblock;
         if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
             pblock = a_recent_block;
-        } else if (inv.type == MSG_WITNESS_BLOCK) {
+        } else if (inv.type == MSG_BLOCK || inv.type == MSG_WITNESS_BLOCK) {
             // Fast-path: in this case it is possible to serve the block directly from disk,
-            // as the network format matches the format on disk
-            std::vector<uint8_t> block_data;
-            if (!ReadRawBlockFromDisk(block_data, pindex, Params().MessageStart())) {
+            // as the network format matches the format on disk. Transactions never carry
+            // witness data, so SERIALIZE_TRANSACTION_NO_WITNESS doesn't change it either.
+            std::shared_ptr<const std::vector<uint8_t>> block_data = ReadRawBlockCached(pindex, Params().MessageStart());
+            if (!block_data) {
                 assert(!"cannot load block from disk");
             }
-            connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, MakeSpan(block_data)));
+            CSerializedNetMsg msg;
+            msg.command = NetMsgType::BLOCK;
+            msg.data = *block_data;
+            connman->PushMessage(pfrom, std::move(msg));
         } else {
             // Send block from disk
             std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
@@ -2062,7 +2241,7 @@ void static ProcessOrphanTx(CConnman* connman, std::set<uint256>& orphan_work_se
     }
 }
 
-bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, int64_t nTimeReceived, const CChainParams& chainparams, CConnman* connman, const std::atomic<bool>& interruptMsgProc, bool enable_bip61)
+bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, int64_t nTimeReceived, const CChainParams& chainparams, CConnman* connman, const std::atomic<bool>& interruptMsgProc, bool enable_bip61, ExtensionMessageQueue* extension_queue)
 {
     LogPrint(BCLog::NET, "received: %s (%u bytes) peer=%d\n", SanitizeString(strCommand), vRecv.size(), pfrom->GetId());
     if (gArgs.IsArgSet("-dropmessagestest") && GetRand(gArgs.GetArg("-dropmessagestest", 0)) == 0)
@@ -3148,7 +3327,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         } // cs_main
 
         if (fProcessBLOCKTXN)
-            return ProcessMessage(pfrom, NetMsgType::BLOCKTXN, blockTxnMsg, nTimeReceived, chainparams, connman, interruptMsgProc, enable_bip61);
+            return ProcessMessage(pfrom, NetMsgType::BLOCKTXN, blockTxnMsg, nTimeReceived, chainparams, connman, interruptMsgProc, enable_bip61, extension_queue);
 
         if (fRevertToHeaderProcessing) {
             // Headers received from HB compact block peers are permitted to be
@@ -3593,14 +3772,18 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
 
         LOCK(cs_main);
 
-        CSimplifiedMNListDiff mnListDiff;
+        std::shared_ptr<const std::vector<unsigned char>> mnListDiffData;
         std::string strError;
-        if (BuildSimplifiedMNListDiff(cmd.baseBlockHash, cmd.blockHash, mnListDiff, strError)) {
-            connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::MNLISTDIFF, mnListDiff));
+        if (GetSerializedSimplifiedMNListDiff(cmd.baseBlockHash, cmd.blockHash, pfrom->GetSendVersion(), mnListDiffData, strError)) {
+            CSerializedNetMsg msg;
+            msg.command = NetMsgType::MNLISTDIFF;
+            msg.data = *mnListDiffData;
+            connman->PushMessage(pfrom, std::move(msg));
         } else {
             LogPrint(BCLog::NET, "getmnlistdiff failed for baseBlockHash=%s, blockHash=%s. error=%s\n", cmd.baseBlockHash.ToString(), cmd.blockHash.ToString(), strError);
             Misbehaving(pfrom->GetId(), 1);
         }
+        return true;
     }
 
     if (strCommand == NetMsgType::MNLISTDIFF) {
@@ -3608,6 +3791,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         LOCK(cs_main);
         Misbehaving(pfrom->GetId(), 100);
         LogPrint(BCLog::NET, "received not-requested mnlistdiff. peer=%d\n", pfrom->GetId());
+        return true;
     }
 
     if (strCommand == NetMsgType::NOTFOUND) {
@@ -3648,20 +3832,9 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         if (found)
         {
             //probably one the extensions
-#ifdef ENABLE_WALLET
-            privateSendClient.ProcessMessage(pfrom, strCommand, vRecv, *connman);
-#endif // ENABLE_WALLET
-            privateSendServer.ProcessMessage(pfrom, strCommand, vRecv, *connman);
-            sporkManager.ProcessSpork(pfrom, strCommand, vRecv, *connman);
-            masternodeSync.ProcessMessage(pfrom, strCommand, vRecv);
-            governance.ProcessMessage(pfrom, strCommand, vRecv, *connman);
-            CMNAuth::ProcessMessage(pfrom, strCommand, vRecv, *connman);
-            llmq::quorumBlockProcessor->ProcessMessage(pfrom, strCommand, vRecv, *connman);
-            llmq::quorumDKGSessionManager->ProcessMessage(pfrom, strCommand, vRecv, *connman);
-            llmq::quorumSigSharesManager->ProcessMessage(pfrom, strCommand, vRecv, *connman);
-            llmq::quorumSigningManager->ProcessMessage(pfrom, strCommand, vRecv, *connman);
-            llmq::chainLocksHandler->ProcessMessage(pfrom, strCommand, vRecv, *connman);
-            llmq::quorumInstantSendManager->ProcessMessage(pfrom, strCommand, vRecv, *connman);
+            if (!extension_queue || !extension_queue->Push(pfrom, strCommand, std::move(vRecv))) {
+                ProcessExtensionMessage(pfrom, strCommand, vRecv, connman);
+            }
         }
         else
         {
@@ -3752,6 +3925,12 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
     if (pfrom->fPauseSend)
         return false;
 
+    // Core messages are processed right away and may overtake this peer's masternode subsystem
+    // messages still waiting for a worker. Only once those exceed MAX_MN_MSG_QUEUE_BYTES do we stop
+    // taking messages from this peer, until its worker has caught up
+    if (m_extension_queue && m_extension_queue->IsBacklogged(pfrom->GetId()))
+        return false;
+
     std::list<CNetMessage> msgs;
     {
         LOCK(pfrom->cs_vProcessMsg);
@@ -3801,7 +3980,7 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
     bool fRet = false;
     try
     {
-        fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime, chainparams, connman, interruptMsgProc, m_enable_bip61);
+        fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime, chainparams, connman, interruptMsgProc, m_enable_bip61, m_extension_queue.get());
         if (interruptMsgProc)
             return false;
         if (!pfrom->vRecvGetData.empty())
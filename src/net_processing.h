@@ -12,6 +12,14 @@
 #include <consensus/params.h>
 #include <sync.h>
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
 extern CCriticalSection cs_main;
 
 /** Default for -maxorphantx, maximum number of orphan transactions kept in memory */
@@ -21,15 +29,84 @@ static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN = 100;
 /** Default for BIP61 (sending reject messages) */
 static constexpr bool DEFAULT_ENABLE_BIP61{false};
 static const bool DEFAULT_PEERBLOOMFILTERS = false;
+/** Default for -mnmsgthreads, number of threads processing masternode subsystem messages */
+static const int DEFAULT_MN_MSG_THREADS = 1;
+/** Maximum number of threads processing masternode subsystem messages */
+static const int MAX_MN_MSG_THREADS = 8;
+/** Maximum size of the masternode subsystem messages queued for a single peer (in bytes) */
+static const size_t MAX_MN_MSG_QUEUE_BYTES = 2 * 1000 * 1000;
+
+/**
+ * Worker threads for the masternode subsystem messages, so that slow handlers (a governance sync,
+ * DKG contributions, batches of sig shares) do not delay block and transaction relay on the
+ * message handler thread.
+ *
+ * Every peer is assigned to one worker, which processes the peer's masternode subsystem messages
+ * in the order they were received. The message handler keeps processing the peer's other messages
+ * in the meantime, so those can overtake queued masternode subsystem messages. Only once the
+ * messages queued for a peer exceed MAX_MN_MSG_QUEUE_BYTES does the message handler stop taking
+ * messages from that peer until its worker catches up, and the peer's receive buffer fills up as it
+ * would behind a slow handler thread. Other peers are unaffected.
+ */
+class ExtensionMessageQueue
+{
+public:
+    typedef std::function<void(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv)> Handler;
+
+    ExtensionMessageQueue(CConnman* connman, int n_threads, Handler handler);
+    ~ExtensionMessageQueue() { Stop(); }
+
+    /** Queue a message for processing. Holds a reference to pfrom until then. Returns false once stopped. */
+    bool Push(CNode* pfrom, const std::string& strCommand, CDataStream&& vRecv);
+    /** Size of the messages queued for a peer, including their message headers. */
+    size_t GetQueuedBytes(NodeId nodeid);
+    /** Whether the messages queued for a peer exceed MAX_MN_MSG_QUEUE_BYTES. */
+    bool IsBacklogged(NodeId nodeid);
+    /** Stop the workers and drop all queued messages. */
+    void Stop();
+
+private:
+    struct Job {
+        CNode* pfrom;
+        std::string strCommand;
+        CDataStream vRecv;
+        //! Size of the message as queued, handlers may consume vRecv
+        size_t nSize;
+    };
+
+    CConnman* const m_connman;
+    const Handler m_handler;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! Queued messages, one queue per worker
+    std::vector<std::deque<Job>> m_queues GUARDED_BY(m_mutex);
+    //! Size of the messages queued for each peer
+    std::map<NodeId, size_t> m_peer_bytes GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    std::vector<std::string> m_thread_names;
+    std::vector<std::thread> m_threads;
+
+    void ThreadProcess(size_t index);
+    /** Account for a processed or dropped message. Returns whether the peer is no longer backlogged. */
+    bool Release(const Job& job) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
 
 class PeerLogicValidation final : public CValidationInterface, public NetEventsInterface {
 private:
     CConnman* const connman;
     BanMan* const m_banman;
+    //! Worker threads for the masternode subsystem messages, null if they are processed inline
+    std::unique_ptr<ExtensionMessageQueue> m_extension_queue;
 
     bool SendRejectsAndCheckIfBanned(CNode* pnode, bool enable_bip61) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 public:
-    PeerLogicValidation(CConnman* connman, BanMan* banman, CScheduler &scheduler, bool enable_bip61);
+    PeerLogicValidation(CConnman* connman, BanMan* banman, CScheduler &scheduler, bool enable_bip61, int n_mn_msg_threads = 0);
+    ~PeerLogicValidation();
+
+    /** Stop the masternode subsystem message threads. Must be called before the nodes are deleted. */
+    void StopExtensionMessageThreads();
 
     void BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexConnected, const std::vector<CTransactionRef>& vtxConflicted) override;
     void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override;
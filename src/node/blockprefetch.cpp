@@ -0,0 +1,166 @@
+// Copyright (c) 2019-2020 Zentoshi LLC
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockprefetch.h>
+
+#include <chain.h>
+#include <primitives/block.h>
+#include <serialize.h>
+#include <tinyformat.h>
+#include <util/system.h>
+#include <validation.h>
+#include <version.h>
+
+#include <functional>
+
+struct BlockPrefetcher::Entry
+{
+    enum class State { QUEUED, READING, DONE, FAILED };
+
+    const CBlockIndex* const pindex;
+    State state{State::QUEUED};
+    CBlock block;
+    //! Serialized size of block, once it is accounted for in m_bytes
+    size_t size{0};
+    //! Set when the entry is removed from the queue while a helper thread is reading it
+    bool dropped{false};
+
+    explicit Entry(const CBlockIndex* pindex_in) : pindex(pindex_in) {}
+};
+
+BlockPrefetcher::BlockPrefetcher(const Consensus::Params& consensus_params, const std::string& name,
+                                 int n_threads, size_t max_blocks, size_t max_bytes)
+    : m_consensus_params(consensus_params), m_max_blocks(max_blocks), m_max_bytes(max_bytes)
+{
+    if (max_blocks == 0) n_threads = 0;
+    // TraceThread keeps a pointer to the name, so all names are created before any thread starts.
+    for (int i = 0; i < n_threads; ++i) {
+        m_thread_names.push_back(strprintf("%s.prefetch.%d", name, i));
+    }
+    for (const auto& thread_name : m_thread_names) {
+        m_threads.emplace_back(&TraceThread<std::function<void()>>, thread_name.c_str(),
+                               std::bind(&BlockPrefetcher::ThreadRead, this));
+    }
+}
+
+BlockPrefetcher::~BlockPrefetcher()
+{
+    {
+        LOCK(m_mutex);
+        m_stop = true;
+        Clear();
+    }
+    m_work_cv.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void BlockPrefetcher::Clear()
+{
+    for (const auto& entry : m_queue) {
+        entry->dropped = true;
+    }
+    m_queue.clear();
+    m_bytes = 0;
+}
+
+void BlockPrefetcher::ThreadRead()
+{
+    while (true) {
+        std::shared_ptr<Entry> entry;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_work_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                if (m_stop) return true;
+                for (const auto& queued : m_queue) {
+                    if (queued->state != Entry::State::QUEUED) continue;
+                    // Always read the block the consumer is waiting for, even over the memory cap.
+                    if (m_bytes >= m_max_bytes && queued != m_queue.front()) return false;
+                    entry = queued;
+                    return true;
+                }
+                return false;
+            });
+            if (m_stop) return;
+            entry->state = Entry::State::READING;
+        }
+
+        const bool read = ReadBlockFromDisk(entry->block, entry->pindex, m_consensus_params);
+        const size_t size = read ? ::GetSerializeSize(entry->block, PROTOCOL_VERSION) : 0;
+        {
+            LOCK(m_mutex);
+            entry->state = read ? Entry::State::DONE : Entry::State::FAILED;
+            if (!entry->dropped) {
+                entry->size = size;
+                m_bytes += size;
+            }
+        }
+        m_done_cv.notify_all();
+    }
+}
+
+void BlockPrefetcher::Schedule(const CBlockIndex* pindex)
+{
+    if (m_threads.empty()) return;
+
+    const CBlockIndex* tail;
+    size_t n_free;
+    {
+        LOCK(m_mutex);
+        if (m_queue.size() >= m_max_blocks) return;
+        tail = m_queue.empty() ? pindex : m_queue.back()->pindex;
+        n_free = m_max_blocks - m_queue.size();
+    }
+
+    std::vector<const CBlockIndex*> next;
+    {
+        LOCK(cs_main);
+        while (next.size() < n_free) {
+            tail = ::ChainActive().Next(tail);
+            if (!tail || !(tail->nStatus & BLOCK_HAVE_DATA)) break;
+            next.push_back(tail);
+        }
+    }
+    if (next.empty()) return;
+
+    {
+        LOCK(m_mutex);
+        for (const CBlockIndex* pindex_next : next) {
+            m_queue.push_back(std::make_shared<Entry>(pindex_next));
+        }
+    }
+    m_work_cv.notify_all();
+}
+
+bool BlockPrefetcher::ReadBlock(const CBlockIndex* pindex, CBlock& block)
+{
+    std::shared_ptr<Entry> entry;
+    {
+        WAIT_LOCK(m_mutex, lock);
+        if (!m_queue.empty() && m_queue.front()->pindex == pindex) {
+            entry = m_queue.front();
+            m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                return entry->state == Entry::State::DONE || entry->state == Entry::State::FAILED;
+            });
+            m_queue.pop_front();
+            m_bytes -= entry->size;
+        } else {
+            Clear();
+        }
+    }
+    // Freed memory may allow helper threads to read further ahead.
+    m_work_cv.notify_all();
+
+    bool ret;
+    if (entry && entry->state == Entry::State::DONE) {
+        block = std::move(entry->block);
+        ret = true;
+    } else {
+        ret = ReadBlockFromDisk(block, pindex, m_consensus_params);
+    }
+
+    Schedule(pindex);
+    return ret;
+}
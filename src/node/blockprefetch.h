@@ -0,0 +1,82 @@
+// Copyright (c) 2019-2020 Zentoshi LLC
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKPREFETCH_H
+#define BITCOIN_NODE_BLOCKPREFETCH_H
+
+#include <sync.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+namespace Consensus { struct Params; }
+
+//! Number of helper threads reading blocks ahead of a sequential scan
+static constexpr int DEFAULT_BLOCK_PREFETCH_THREADS = 2;
+//! Maximum number of blocks read ahead of a sequential scan
+static constexpr size_t DEFAULT_BLOCK_PREFETCH_BLOCKS = 32;
+//! Maximum serialized size of the blocks held by the prefetcher (in bytes)
+static constexpr size_t DEFAULT_BLOCK_PREFETCH_BYTES = 64 << 20;
+
+/**
+ * Reads and deserializes the blocks of the active chain ahead of a sequential scan, such as an
+ * index sync or a wallet rescan, so that disk latency overlaps with the processing of the
+ * previous blocks.
+ *
+ * Each ReadBlock call returns the requested block and queues reads of its successors in the
+ * active chain. Blocks are handed out in chain order; a request for any block other than the
+ * next queued one (after a reorg, or when the caller skips ahead) drops the queue and restarts
+ * from the requested block. At most max_blocks blocks are queued, and helper threads stop
+ * reading once the blocks held exceed max_bytes.
+ *
+ * A prefetcher serves a single consumer thread. ReadBlock must not be called with cs_main held.
+ */
+class BlockPrefetcher
+{
+public:
+    BlockPrefetcher(const Consensus::Params& consensus_params, const std::string& name,
+                    int n_threads = DEFAULT_BLOCK_PREFETCH_THREADS,
+                    size_t max_blocks = DEFAULT_BLOCK_PREFETCH_BLOCKS,
+                    size_t max_bytes = DEFAULT_BLOCK_PREFETCH_BYTES);
+    ~BlockPrefetcher();
+
+    BlockPrefetcher(const BlockPrefetcher&) = delete;
+    BlockPrefetcher& operator=(const BlockPrefetcher&) = delete;
+
+    /** Same semantics as ReadBlockFromDisk(block, pindex, consensus_params). */
+    bool ReadBlock(const CBlockIndex* pindex, CBlock& block);
+
+private:
+    struct Entry;
+
+    const Consensus::Params& m_consensus_params;
+    const size_t m_max_blocks;
+    const size_t m_max_bytes;
+
+    Mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    //! Queued reads, in chain order
+    std::deque<std::shared_ptr<Entry>> m_queue GUARDED_BY(m_mutex);
+    //! Serialized size of the blocks read and not yet handed out
+    size_t m_bytes GUARDED_BY(m_mutex){0};
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    std::vector<std::string> m_thread_names;
+    std::vector<std::thread> m_threads;
+
+    void ThreadRead();
+    /** Drop all queued reads. */
+    void Clear() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    /** Queue reads of the successors of pindex in the active chain, up to max_blocks. */
+    void Schedule(const CBlockIndex* pindex) LOCKS_EXCLUDED(m_mutex);
+};
+
+#endif // BITCOIN_NODE_BLOCKPREFETCH_H
@@ -8,7 +8,9 @@
 #include <amount.h>
 #include <coins.h>
 #include <chain.h>
+#include <crypto/muhash.h>
 #include <hash.h>
+#include <index/coinstatsindex.h>
 #include <serialize.h>
 #include <validation.h>
 #include <uint256.h>
@@ -19,37 +21,104 @@
 #include <boost/thread.hpp>
 
 
-static void ApplyStats(CCoinsStats &stats, CHashWriter& ss, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
+uint64_t GetBogoSize(const CScript& script_pub_key)
+{
+    return 32 /* txid */ +
+           4 /* vout index */ +
+           4 /* height + coinbase */ +
+           8 /* amount */ +
+           2 /* scriptPubKey len */ +
+           script_pub_key.size() /* scriptPubKey */;
+}
+
+static CDataStream TxOutSer(const COutPoint& outpoint, const Coin& coin)
+{
+    CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+    ss << outpoint;
+    ss << static_cast<uint32_t>(coin.nHeight * 2 + coin.fCoinBase);
+    ss << coin.out;
+    return ss;
+}
+
+void ApplyCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin)
+{
+    CDataStream ss = TxOutSer(outpoint, coin);
+    muhash.Insert((const unsigned char*)ss.data(), ss.size());
+}
+
+void RemoveCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin)
+{
+    CDataStream ss = TxOutSer(outpoint, coin);
+    muhash.Remove((const unsigned char*)ss.data(), ss.size());
+}
+
+static void ApplyHash(CHashWriter& ss, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
 {
-    assert(!outputs.empty());
     ss << hash;
     ss << VARINT(outputs.begin()->second.nHeight * 2 + outputs.begin()->second.fCoinBase ? 1u : 0u);
-    stats.nTransactions++;
     for (const auto& output : outputs) {
         ss << VARINT(output.first + 1);
         ss << output.second.out.scriptPubKey;
         ss << VARINT(output.second.out.nValue, VarIntMode::NONNEGATIVE_SIGNED);
+    }
+    ss << VARINT(0u);
+}
+
+static void ApplyHash(MuHash3072& muhash, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
+{
+    for (const auto& output : outputs) {
+        ApplyCoinHash(muhash, COutPoint(hash, output.first), output.second);
+    }
+}
+
+static void ApplyHash(std::nullptr_t, const uint256& hash, const std::map<uint32_t, Coin>& outputs) {}
+
+template <typename T>
+static void ApplyStats(CCoinsStats& stats, T& hash_obj, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
+{
+    assert(!outputs.empty());
+    ApplyHash(hash_obj, hash, outputs);
+    stats.nTransactions++;
+    for (const auto& output : outputs) {
         stats.nTransactionOutputs++;
         stats.nTotalAmount += output.second.out.nValue;
-        stats.nBogoSize += 32 /* txid */ + 4 /* vout index */ + 4 /* height + coinbase */ + 8 /* amount */ +
-                           2 /* scriptPubKey len */ + output.second.out.scriptPubKey.size() /* scriptPubKey */;
+        stats.nBogoSize += GetBogoSize(output.second.out.scriptPubKey);
     }
-    ss << VARINT(0u);
 }
 
-//! Calculate statistics about the unspent transaction output set
-bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
+static void PrepareHash(CHashWriter& ss, const CCoinsStats& stats)
+{
+    ss << stats.hashBlock;
+}
+static void PrepareHash(MuHash3072& muhash, CCoinsStats& stats) {}
+static void PrepareHash(std::nullptr_t, CCoinsStats& stats) {}
+
+static void FinalizeHash(CHashWriter& ss, CCoinsStats& stats)
+{
+    stats.hashSerialized = ss.GetHash();
+}
+static void FinalizeHash(MuHash3072& muhash, CCoinsStats& stats)
+{
+    uint256 out;
+    muhash.Finalize(out);
+    stats.hashSerialized = out;
+}
+static void FinalizeHash(std::nullptr_t, CCoinsStats& stats) {}
+
+//! Calculate statistics about the unspent transaction output set by walking the chainstate
+template <typename T>
+static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj)
 {
     std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
     assert(pcursor);
 
-    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
     stats.hashBlock = pcursor->GetBestBlock();
     {
         LOCK(cs_main);
         stats.nHeight = LookupBlockIndex(stats.hashBlock)->nHeight;
     }
-    ss << stats.hashBlock;
+    PrepareHash(hash_obj, stats);
+
     uint256 prevkey;
     std::map<uint32_t, Coin> outputs;
     while (pcursor->Valid()) {
@@ -58,7 +127,7 @@ bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
         Coin coin;
         if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
             if (!outputs.empty() && key.hash != prevkey) {
-                ApplyStats(stats, ss, prevkey, outputs);
+                ApplyStats(stats, hash_obj, prevkey, outputs);
                 outputs.clear();
             }
             prevkey = key.hash;
@@ -69,9 +138,48 @@ bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
         pcursor->Next();
     }
     if (!outputs.empty()) {
-        ApplyStats(stats, ss, prevkey, outputs);
+        ApplyStats(stats, hash_obj, prevkey, outputs);
     }
-    stats.hashSerialized = ss.GetHash();
+    FinalizeHash(hash_obj, stats);
     stats.nDiskSize = view->EstimateSize();
     return true;
 }
+
+bool GetUTXOStats(CCoinsView* view, CCoinsStats& stats, CoinStatsHashType hash_type, const CBlockIndex* pindex)
+{
+    // Serve from the index if possible; the legacy serialized hash can only be computed by a scan
+    if (g_coin_stats_index && hash_type != CoinStatsHashType::HASH_SERIALIZED) {
+        if (!pindex) {
+            // The index follows the active chain, while the best block of an unflushed CoinsDB lags behind it
+            LOCK(cs_main);
+            pindex = ::ChainActive().Tip();
+        }
+        if (!pindex || !g_coin_stats_index->LookUpStats(pindex, stats)) {
+            return false;
+        }
+        stats.nDiskSize = view->EstimateSize();
+        stats.from_index = true;
+        if (hash_type == CoinStatsHashType::NONE) {
+            stats.hashSerialized.SetNull();
+        }
+        return true;
+    }
+    if (pindex) {
+        return error("%s: statistics for a specific block require -coinstatsindex", __func__);
+    }
+
+    switch (hash_type) {
+    case CoinStatsHashType::HASH_SERIALIZED: {
+        CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+        return ComputeUTXOStats(view, stats, ss);
+    }
+    case CoinStatsHashType::MUHASH: {
+        MuHash3072 muhash;
+        return ComputeUTXOStats(view, stats, muhash);
+    }
+    case CoinStatsHashType::NONE: {
+        return ComputeUTXOStats(view, stats, nullptr);
+    }
+    } // no default case, so the compiler can warn about missing cases
+    assert(false);
+}
@@ -11,7 +11,18 @@
 
 #include <cstdint>
 
+class CBlockIndex;
 class CCoinsView;
+class COutPoint;
+class CScript;
+class Coin;
+class MuHash3072;
+
+enum class CoinStatsHashType {
+    HASH_SERIALIZED,
+    MUHASH,
+    NONE,
+};
 
 struct CCoinsStats
 {
@@ -24,10 +35,28 @@ struct CCoinsStats
     uint64_t nDiskSize;
     CAmount nTotalAmount;
 
-    CCoinsStats() : nHeight(0), nTransactions(0), nTransactionOutputs(0), nBogoSize(0), nDiskSize(0), nTotalAmount(0) {}
+    //! Whether the stats were looked up in the coinstats index instead of computed by a full scan.
+    //! nTransactions is not tracked by the index and is left at zero in that case.
+    bool from_index;
+
+    CCoinsStats() : nHeight(0), nTransactions(0), nTransactionOutputs(0), nBogoSize(0), nDiskSize(0), nTotalAmount(0), from_index(false) {}
 };
 
-//! Calculate statistics about the unspent transaction output set
-bool GetUTXOStats(CCoinsView* view, CCoinsStats& stats);
+/**
+ * Calculate statistics about the unspent transaction output set.
+ *
+ * For the MUHASH and NONE hash types the result is taken from the coinstats index if it is
+ * enabled, which answers without walking the chainstate. Passing pindex requests the statistics
+ * as of that block, which is only possible through the index. Without it the index answers for
+ * the active chain tip, so the chainstate does not need to be flushed first.
+ */
+bool GetUTXOStats(CCoinsView* view, CCoinsStats& stats, CoinStatsHashType hash_type = CoinStatsHashType::HASH_SERIALIZED, const CBlockIndex* pindex = nullptr);
+
+//! Size of a coin as counted by the bogosize metric
+uint64_t GetBogoSize(const CScript& script_pub_key);
+
+//! Add/remove a coin to/from the rolling MuHash commitment of the UTXO set
+void ApplyCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
+void RemoveCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
 
 #endif // BITCOIN_NODE_COINSTATS_H
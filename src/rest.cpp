@@ -7,12 +7,17 @@
 #include <chain.h>
 #include <chainparams.h>
 #include <core_io.h>
+#include <evo/deterministicmns.h>
+#include <evo/simplifiedmns.h>
 #include <httpserver.h>
 #include <index/txindex.h>
+#include <llmq/quorums.h>
+#include <llmq/quorums_signing.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
 #include <rpc/protocol.h>
+#include <rpc/rpcquorums.h>
 #include <rpc/server.h>
 #include <streams.h>
 #include <sync.h>
@@ -618,6 +623,311 @@ static bool rest_blockhash_by_height(HTTPRequest* req,
     }
 }
 
+UniValue getaddressbalance(const JSONRPCRequest& request);
+UniValue getaddressdeltas(const JSONRPCRequest& request);
+UniValue getaddressutxos(const JSONRPCRequest& request);
+UniValue getspentinfo(const JSONRPCRequest& request);
+
+/** Answer a JSON-only REST query with the result of an index RPC, mapping its errors to HTTP errors. */
+static bool rest_index_query(HTTPRequest* req, RetFormat rf, UniValue (*actor)(const JSONRPCRequest&), const UniValue& params)
+{
+    if (rf != RetFormat::JSON) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+
+    JSONRPCRequest jsonRequest;
+    jsonRequest.params = params;
+    UniValue result;
+    try {
+        result = actor(jsonRequest);
+    } catch (const UniValue& objError) {
+        const int code = find_value(objError, "code").get_int();
+        const std::string message = find_value(objError, "message").get_str();
+        if (code == RPC_INVALID_ADDRESS_OR_KEY) {
+            return RESTERR(req, HTTP_NOT_FOUND, message);
+        }
+        if (code == RPC_MISC_ERROR || code == RPC_INTERNAL_ERROR) {
+            return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, message);
+        }
+        return RESTERR(req, HTTP_BAD_REQUEST, message);
+    } catch (const std::exception& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+
+    req->WriteHeader("Content-Type", "application/json");
+    req->WriteReply(HTTP_OK, result.write() + "\n");
+    return true;
+}
+
+static bool rest_address(HTTPRequest* req, const std::string& strURIPart, UniValue (*actor)(const JSONRPCRequest&))
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string address;
+    const RetFormat rf = ParseDataFormat(address, strURIPart);
+
+    UniValue params(UniValue::VARR);
+    params.push_back(address);
+    return rest_index_query(req, rf, actor, params);
+}
+
+static bool rest_address_balance(HTTPRequest* req, const std::string& strURIPart)
+{
+    return rest_address(req, strURIPart, getaddressbalance);
+}
+
+static bool rest_address_deltas(HTTPRequest* req, const std::string& strURIPart)
+{
+    return rest_address(req, strURIPart, getaddressdeltas);
+}
+
+static bool rest_address_utxos(HTTPRequest* req, const std::string& strURIPart)
+{
+    return rest_address(req, strURIPart, getaddressutxos);
+}
+
+static bool rest_spentinfo(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    // expected format: /rest/spentinfo/<txid>-<n>.json
+    const std::string::size_type pos = param.find('-');
+    int32_t n;
+    uint256 txid;
+    if (pos == std::string::npos || !ParseHashStr(param.substr(0, pos), txid) || !ParseInt32(param.substr(pos + 1), &n)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Parse error");
+    }
+
+    UniValue params(UniValue::VARR);
+    params.push_back(txid.GetHex());
+    params.push_back(n);
+    return rest_index_query(req, rf, getspentinfo, params);
+}
+
+/** Reply with data serialized by the node, in binary or hex format. */
+static bool rest_serialized_reply(HTTPRequest* req, RetFormat rf, const std::string& data)
+{
+    if (rf == RetFormat::BINARY) {
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, data);
+    } else {
+        assert(rf == RetFormat::HEX);
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, HexStr(data.begin(), data.end()) + "\n");
+    }
+    return true;
+}
+
+static bool rest_mnlist(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string hashStr;
+    const RetFormat rf = ParseDataFormat(hashStr, strURIPart);
+
+    uint256 hash;
+    if (!ParseHashStr(hashStr, hash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+
+    CDeterministicMNList mnList;
+    {
+        LOCK(cs_main);
+        const CBlockIndex* pblockindex = LookupBlockIndex(hash);
+        if (!pblockindex) {
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        }
+        mnList = deterministicMNManager->GetListForBlock(pblockindex);
+    }
+
+    switch (rf) {
+    case RetFormat::BINARY:
+    case RetFormat::HEX: {
+        CDataStream ssMNList(SER_NETWORK, PROTOCOL_VERSION);
+        ssMNList << mnList;
+        return rest_serialized_reply(req, rf, ssMNList.str());
+    }
+
+    case RetFormat::JSON: {
+        UniValue jsonMNs(UniValue::VARR);
+        mnList.ForEachMN(false, [&](const CDeterministicMNCPtr& dmn) {
+            UniValue obj;
+            dmn->ToJson(obj);
+            jsonMNs.push_back(obj);
+        });
+        UniValue objMNList(UniValue::VOBJ);
+        objMNList.pushKV("blockHash", mnList.GetBlockHash().ToString());
+        objMNList.pushKV("height", mnList.GetHeight());
+        objMNList.pushKV("totalRegisteredCount", (int64_t)mnList.GetTotalRegisteredCount());
+        objMNList.pushKV("masternodes", jsonMNs);
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, objMNList.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool rest_mnlistdiff(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() != 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Use /rest/mnlistdiff/<basehash>/<hash>.<ext>.");
+
+    uint256 baseBlockHash, blockHash;
+    if (!ParseHashStr(path[0], baseBlockHash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + path[0]);
+    if (!ParseHashStr(path[1], blockHash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + path[1]);
+
+    std::string strError;
+    switch (rf) {
+    case RetFormat::BINARY:
+    case RetFormat::HEX: {
+        // Same bytes as the MNLISTDIFF p2p message, shared with its cache
+        std::shared_ptr<const std::vector<unsigned char>> data;
+        {
+            LOCK(cs_main);
+            if (!GetSerializedSimplifiedMNListDiff(baseBlockHash, blockHash, PROTOCOL_VERSION, data, strError)) {
+                return RESTERR(req, HTTP_NOT_FOUND, strError);
+            }
+        }
+        return rest_serialized_reply(req, rf, std::string(data->begin(), data->end()));
+    }
+
+    case RetFormat::JSON: {
+        CSimplifiedMNListDiff mnListDiff;
+        {
+            LOCK(cs_main);
+            if (!BuildSimplifiedMNListDiff(baseBlockHash, blockHash, mnListDiff, strError)) {
+                return RESTERR(req, HTTP_NOT_FOUND, strError);
+            }
+        }
+        UniValue objDiff;
+        mnListDiff.ToJson(objDiff);
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, objDiff.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+/** Parse the <llmqType>/<hash> part shared by the quorum and recovered signature URIs. */
+static bool ParseLLMQTypeAndHash(const std::string& param, Consensus::LLMQType& llmqType, uint256& hash, std::string& strError)
+{
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+    if (path.size() != 2) {
+        strError = "Invalid URI format";
+        return false;
+    }
+
+    int32_t type;
+    if (!ParseInt32(path[0], &type) || !Params().GetConsensus().llmqs.count((Consensus::LLMQType)type)) {
+        strError = "Invalid LLMQ type: " + SanitizeString(path[0]);
+        return false;
+    }
+    if (!ParseHashStr(path[1], hash)) {
+        strError = "Invalid hash: " + SanitizeString(path[1]);
+        return false;
+    }
+    llmqType = (Consensus::LLMQType)type;
+    return true;
+}
+
+static bool rest_quorum(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    Consensus::LLMQType llmqType;
+    uint256 quorumHash;
+    std::string strError;
+    if (!ParseLLMQTypeAndHash(param, llmqType, quorumHash, strError))
+        return RESTERR(req, HTTP_BAD_REQUEST, strError + ". Use /rest/quorum/<llmqtype>/<quorumhash>.<ext>.");
+
+    llmq::CQuorumCPtr quorum = llmq::quorumManager->GetQuorum(llmqType, quorumHash);
+    if (!quorum) {
+        return RESTERR(req, HTTP_NOT_FOUND, quorumHash.ToString() + " not found");
+    }
+
+    switch (rf) {
+    case RetFormat::BINARY:
+    case RetFormat::HEX: {
+        // The final commitment that was mined for the quorum
+        CDataStream ssCommitment(SER_NETWORK, PROTOCOL_VERSION);
+        ssCommitment << quorum->qc;
+        return rest_serialized_reply(req, rf, ssCommitment.str());
+    }
+
+    case RetFormat::JSON: {
+        UniValue objQuorum = BuildQuorumInfo(quorum, true, false);
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, objQuorum.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool rest_recsig(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    Consensus::LLMQType llmqType;
+    uint256 id;
+    std::string strError;
+    if (!ParseLLMQTypeAndHash(param, llmqType, id, strError))
+        return RESTERR(req, HTTP_BAD_REQUEST, strError + ". Use /rest/recsig/<llmqtype>/<id>.<ext>.");
+
+    llmq::CRecoveredSig recSig;
+    if (!llmq::quorumSigningManager->GetRecoveredSigForId(llmqType, id, recSig)) {
+        return RESTERR(req, HTTP_NOT_FOUND, id.ToString() + " not found");
+    }
+
+    switch (rf) {
+    case RetFormat::BINARY:
+    case RetFormat::HEX: {
+        CDataStream ssRecSig(SER_NETWORK, PROTOCOL_VERSION);
+        ssRecSig << recSig;
+        return rest_serialized_reply(req, rf, ssRecSig.str());
+    }
+
+    case RetFormat::JSON: {
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, recSig.ToJson().write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(HTTPRequest* req, const std::string& strReq);
@@ -631,6 +941,14 @@ static const struct {
       {"/rest/headers/", rest_headers},
       {"/rest/getutxos", rest_getutxos},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/addressbalance/", rest_address_balance},
+      {"/rest/addressdeltas/", rest_address_deltas},
+      {"/rest/addressutxos/", rest_address_utxos},
+      {"/rest/spentinfo/", rest_spentinfo},
+      {"/rest/mnlistdiff/", rest_mnlistdiff},
+      {"/rest/mnlist/", rest_mnlist},
+      {"/rest/quorum/", rest_quorum},
+      {"/rest/recsig/", rest_recsig},
 };
 
 void StartREST()
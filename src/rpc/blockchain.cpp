@@ -14,7 +14,11 @@
 #include <consensus/validation.h>
 #include <core_io.h>
 #include <hash.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
+#include <index/coinstatsindex.h>
+#include <index/spentindex.h>
+#include <key_io.h>
 #include <policy/feerate.h>
 #include <policy/policy.h>
 #include <policy/rbf.h>
@@ -22,6 +26,7 @@
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <script/descriptor.h>
+#include <script/standard.h>
 #include <streams.h>
 #include <sync.h>
 #include <txdb.h>
@@ -982,46 +987,113 @@ static UniValue pruneblockchain(const JSONRPCRequest& request)
     return uint64_t(block->nHeight);
 }
 
+static CoinStatsHashType ParseHashType(const UniValue& param)
+{
+    const std::string hash_type_input = param.isNull() ? "hash_serialized_2" : param.get_str();
+
+    if (hash_type_input == "hash_serialized_2") {
+        return CoinStatsHashType::HASH_SERIALIZED;
+    } else if (hash_type_input == "muhash") {
+        return CoinStatsHashType::MUHASH;
+    } else if (hash_type_input == "none") {
+        return CoinStatsHashType::NONE;
+    }
+    throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("%s is not a valid hash_type", hash_type_input));
+}
+
 static UniValue gettxoutsetinfo(const JSONRPCRequest& request)
 {
             RPCHelpMan{"gettxoutsetinfo",
                 "\nReturns statistics about the unspent transaction output set.\n"
-                "Note this call may take some time.\n",
-                {},
+                "Note this call may take some time if the coinstatsindex is not enabled or hash_type is hash_serialized_2.\n",
+                {
+                    {"hash_type", RPCArg::Type::STR, /* default */ "hash_serialized_2", "Which UTXO set hash should be calculated. Options: 'hash_serialized_2' (the legacy algorithm), 'muhash', 'none'."},
+                    {"hash_or_height", RPCArg::Type::NUM, RPCArg::Optional::OMITTED_NAMED_ARG, "The block hash or height of the target height (only available with coinstatsindex).", "", {"", "string or numeric"}},
+                },
                 RPCResult{
             "{\n"
-            "  \"height\":n,     (numeric) The current block height (index)\n"
-            "  \"bestblock\": \"hex\",   (string) The hash of the block at the tip of the chain\n"
-            "  \"transactions\": n,      (numeric) The number of transactions with unspent outputs\n"
+            "  \"height\":n,     (numeric) The block height (index) of the returned statistics\n"
+            "  \"bestblock\": \"hex\",   (string) The hash of the block at which these statistics are calculated\n"
+            "  \"transactions\": n,      (numeric) The number of transactions with unspent outputs (not available when the coinstatsindex is used)\n"
             "  \"txouts\": n,            (numeric) The number of unspent transaction outputs\n"
             "  \"bogosize\": n,          (numeric) A meaningless metric for UTXO set size\n"
-            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash\n"
+            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash (only present if 'hash_serialized_2' hash_type is chosen)\n"
+            "  \"muhash\": \"hash\",       (string) The MuHash3072 commitment to the UTXO set (only present if 'muhash' hash_type is chosen)\n"
             "  \"disk_size\": n,         (numeric) The estimated size of the chainstate on disk\n"
             "  \"total_amount\": x.xxx          (numeric) The total amount\n"
             "}\n"
                 },
                 RPCExamples{
                     HelpExampleCli("gettxoutsetinfo", "")
-            + HelpExampleRpc("gettxoutsetinfo", "")
+            + HelpExampleCli("gettxoutsetinfo", "\"none\"")
+            + HelpExampleCli("gettxoutsetinfo", "\"none\" 1000")
+            + HelpExampleCli("gettxoutsetinfo", "\"muhash\" '\"00000000000000000000000000000000000000000000000000000000000000ab\"'")
+            + HelpExampleRpc("gettxoutsetinfo", "\"none\"")
                 },
             }.Check(request);
 
     UniValue ret(UniValue::VOBJ);
 
     CCoinsStats stats;
-    ::ChainstateActive().ForceFlushStateToDisk();
+    const CoinStatsHashType hash_type = ParseHashType(request.params[0]);
+
+    const CBlockIndex* pindex = nullptr;
+    if (!request.params[1].isNull()) {
+        if (!g_coin_stats_index) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Querying specific block heights requires coinstatsindex");
+        }
+        if (hash_type == CoinStatsHashType::HASH_SERIALIZED) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "hash_serialized_2 hash type cannot be queried for a specific block");
+        }
+
+        LOCK(cs_main);
+        if (request.params[1].isNum()) {
+            const int height = request.params[1].get_int();
+            const int current_tip = ::ChainActive().Height();
+            if (height < 0) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Target block height %d is negative", height));
+            }
+            if (height > current_tip) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Target block height %d after current tip %d", height, current_tip));
+            }
+            pindex = ::ChainActive()[height];
+        } else {
+            const uint256 hash(ParseHashV(request.params[1], "hash_or_height"));
+            pindex = LookupBlockIndex(hash);
+            if (!pindex) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+            }
+        }
+    }
+
+    if (g_coin_stats_index && hash_type != CoinStatsHashType::HASH_SERIALIZED) {
+        // Allow the index to catch up with blocks connected so far
+        g_coin_stats_index->BlockUntilSyncedToCurrentChain();
+    } else {
+        ::ChainstateActive().ForceFlushStateToDisk();
+    }
 
     CCoinsView* coins_view = WITH_LOCK(cs_main, return &ChainstateActive().CoinsDB());
-    if (GetUTXOStats(coins_view, stats)) {
+    if (GetUTXOStats(coins_view, stats, hash_type, pindex)) {
         ret.pushKV("height", (int64_t)stats.nHeight);
         ret.pushKV("bestblock", stats.hashBlock.GetHex());
-        ret.pushKV("transactions", (int64_t)stats.nTransactions);
+        if (!stats.from_index) {
+            ret.pushKV("transactions", (int64_t)stats.nTransactions);
+        }
         ret.pushKV("txouts", (int64_t)stats.nTransactionOutputs);
         ret.pushKV("bogosize", (int64_t)stats.nBogoSize);
-        ret.pushKV("hash_serialized_2", stats.hashSerialized.GetHex());
+        if (hash_type == CoinStatsHashType::HASH_SERIALIZED) {
+            ret.pushKV("hash_serialized_2", stats.hashSerialized.GetHex());
+        }
+        if (hash_type == CoinStatsHashType::MUHASH) {
+            ret.pushKV("muhash", stats.hashSerialized.GetHex());
+        }
         ret.pushKV("disk_size", stats.nDiskSize);
         ret.pushKV("total_amount", ValueFromAmount(stats.nTotalAmount));
     } else {
+        if (g_coin_stats_index && hash_type != CoinStatsHashType::HASH_SERIALIZED) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set statistics from coinstatsindex; it may still be syncing");
+        }
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
     }
     return ret;
@@ -2295,6 +2367,315 @@ static UniValue getblockfilter(const JSONRPCRequest& request)
     return ret;
 }
 
+static std::vector<std::pair<std::string, CScript>> ParseAddresses(const UniValue& param)
+{
+    std::vector<std::string> addresses;
+    UniValue array;
+    if (param.isArray()) {
+        array = param;
+    } else if (param.isStr() && !param.get_str().empty() && param.get_str()[0] == '[') {
+        // zentoshi-cli passes the addresses argument unconverted, so that a plain address works there as well
+        if (!array.read(param.get_str()) || !array.isArray()) {
+            throw JSONRPCError(RPC_TYPE_ERROR, "Error parsing JSON:" + param.get_str());
+        }
+    } else if (param.isStr()) {
+        addresses.push_back(param.get_str());
+    } else {
+        throw JSONRPCError(RPC_TYPE_ERROR, "Addresses are expected to be a string or an array of strings");
+    }
+    for (const UniValue& address : array.getValues()) {
+        addresses.push_back(address.get_str());
+    }
+
+    std::vector<std::pair<std::string, CScript>> result;
+    for (const std::string& address : addresses) {
+        CTxDestination dest = DecodeDestination(address);
+        if (!IsValidDestination(dest)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address: " + address);
+        }
+        result.emplace_back(address, GetScriptForDestination(dest));
+    }
+    return result;
+}
+
+static AddressIndex& EnsureAddressIndex()
+{
+    if (!g_addressindex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index not enabled (start with -addressindex)");
+    }
+    if (!g_addressindex->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index is still syncing");
+    }
+    return *g_addressindex;
+}
+
+UniValue getaddressbalance(const JSONRPCRequest& request)
+{
+            RPCHelpMan{"getaddressbalance",
+                "\nReturns the balance of one or more addresses (requires -addressindex).\n",
+                {
+                    {"addresses", RPCArg::Type::ARR, RPCArg::Optional::NO, "The addresses (or a single address string)",
+                        {
+                            {"address", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "The address"},
+                        },
+                    },
+                },
+                RPCResult{
+            "{\n"
+            "  \"balance\": n,   (numeric) The current balance in satoshis\n"
+            "  \"received\": n   (numeric) The total number of satoshis received (including change)\n"
+            "}\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getaddressbalance", "1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc")
+            + HelpExampleCli("getaddressbalance", "'[\"1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc\"]'")
+            + HelpExampleRpc("getaddressbalance", "[\"1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc\"]")
+                },
+            }.Check(request);
+
+    const auto addresses = ParseAddresses(request.params[0]);
+    const AddressIndex& index = EnsureAddressIndex();
+
+    CAmount balance = 0;
+    CAmount received = 0;
+    for (const auto& address : addresses) {
+        CAmount address_balance, address_received;
+        if (!index.GetBalance(address.second, address_balance, address_received)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read balance for address " + address.first);
+        }
+        balance += address_balance;
+        received += address_received;
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("balance", balance);
+    result.pushKV("received", received);
+    return result;
+}
+
+static std::vector<std::pair<const std::string*, CAddressDelta>> GetAddressDeltas(const JSONRPCRequest& request, const std::vector<std::pair<std::string, CScript>>& addresses)
+{
+    int start = 0;
+    int end = -1;
+    if (!request.params[1].isNull()) {
+        start = request.params[1].get_int();
+    }
+    if (!request.params[2].isNull()) {
+        end = request.params[2].get_int();
+    }
+    if (start < 0 || (end >= 0 && end < start)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Start and end heights are expected to be non-negative and in order");
+    }
+
+    const AddressIndex& index = EnsureAddressIndex();
+
+    std::vector<std::pair<const std::string*, CAddressDelta>> result;
+    for (const auto& address : addresses) {
+        std::vector<CAddressDelta> deltas;
+        if (!index.GetDeltas(address.second, start, end, deltas)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read history for address " + address.first);
+        }
+        for (auto& delta : deltas) {
+            result.emplace_back(&address.first, std::move(delta));
+        }
+    }
+
+    // Each address's history is already ordered, only merge them when several were requested
+    if (addresses.size() > 1) {
+        std::stable_sort(result.begin(), result.end(), [](const std::pair<const std::string*, CAddressDelta>& a, const std::pair<const std::string*, CAddressDelta>& b) {
+            return std::make_pair(a.second.height, a.second.tx_index) < std::make_pair(b.second.height, b.second.tx_index);
+        });
+    }
+    return result;
+}
+
+UniValue getaddressdeltas(const JSONRPCRequest& request)
+{
+            RPCHelpMan{"getaddressdeltas",
+                "\nReturns all changes to the balance of one or more addresses (requires -addressindex).\n",
+                {
+                    {"addresses", RPCArg::Type::ARR, RPCArg::Optional::NO, "The addresses (or a single address string)",
+                        {
+                            {"address", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "The address"},
+                        },
+                    },
+                    {"start", RPCArg::Type::NUM, /* default */ "0", "The start block height"},
+                    {"end", RPCArg::Type::NUM, /* default */ "tip", "The end block height (inclusive)"},
+                },
+                RPCResult{
+            "[\n"
+            "  {\n"
+            "    \"satoshis\": n,      (numeric) The difference of satoshis\n"
+            "    \"txid\": \"hash\",     (string) The related txid\n"
+            "    \"index\": n,         (numeric) The related input or output index\n"
+            "    \"blockindex\": n,    (numeric) The related block index\n"
+            "    \"height\": n,        (numeric) The block height\n"
+            "    \"address\": \"str\"    (string) The address\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getaddressdeltas", "1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc 1000 2000")
+            + HelpExampleCli("getaddressdeltas", "'[\"1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc\"]' 1000 2000")
+            + HelpExampleRpc("getaddressdeltas", "[\"1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc\"], 1000, 2000")
+                },
+            }.Check(request);
+
+    const auto addresses = ParseAddresses(request.params[0]);
+
+    UniValue result(UniValue::VARR);
+    for (const auto& entry : GetAddressDeltas(request, addresses)) {
+        const CAddressDelta& delta = entry.second;
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("satoshis", delta.amount);
+        obj.pushKV("txid", delta.txid.GetHex());
+        obj.pushKV("index", (int)delta.index);
+        obj.pushKV("blockindex", (int)delta.tx_index);
+        obj.pushKV("height", delta.height);
+        obj.pushKV("address", *entry.first);
+        result.push_back(obj);
+    }
+    return result;
+}
+
+static UniValue getaddresstxids(const JSONRPCRequest& request)
+{
+            RPCHelpMan{"getaddresstxids",
+                "\nReturns the txids of all transactions paying to or spending from one or more addresses (requires -addressindex).\n",
+                {
+                    {"addresses", RPCArg::Type::ARR, RPCArg::Optional::NO, "The addresses (or a single address string)",
+                        {
+                            {"address", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "The address"},
+                        },
+                    },
+                    {"start", RPCArg::Type::NUM, /* default */ "0", "The start block height"},
+                    {"end", RPCArg::Type::NUM, /* default */ "tip", "The end block height (inclusive)"},
+                },
+                RPCResult{
+            "[\n"
+            "  \"transactionid\"  (string) The transaction id\n"
+            "  ,...\n"
+            "]\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getaddresstxids", "1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc")
+            + HelpExampleCli("getaddresstxids", "'[\"1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc\"]'")
+            + HelpExampleRpc("getaddresstxids", "[\"1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc\"]")
+                },
+            }.Check(request);
+
+    const auto addresses = ParseAddresses(request.params[0]);
+
+    UniValue result(UniValue::VARR);
+    std::set<uint256> seen;
+    for (const auto& entry : GetAddressDeltas(request, addresses)) {
+        if (seen.insert(entry.second.txid).second) {
+            result.push_back(entry.second.txid.GetHex());
+        }
+    }
+    return result;
+}
+
+UniValue getaddressutxos(const JSONRPCRequest& request)
+{
+            RPCHelpMan{"getaddressutxos",
+                "\nReturns all unspent outputs of one or more addresses (requires -addressindex).\n",
+                {
+                    {"addresses", RPCArg::Type::ARR, RPCArg::Optional::NO, "The addresses (or a single address string)",
+                        {
+                            {"address", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "The address"},
+                        },
+                    },
+                },
+                RPCResult{
+            "[\n"
+            "  {\n"
+            "    \"address\": \"str\",   (string) The address\n"
+            "    \"txid\": \"hash\",     (string) The output txid\n"
+            "    \"outputIndex\": n,   (numeric) The output index\n"
+            "    \"script\": \"hex\",    (string) The script hex-encoded\n"
+            "    \"satoshis\": n,      (numeric) The number of satoshis of the output\n"
+            "    \"height\": n         (numeric) The block height\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getaddressutxos", "1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc")
+            + HelpExampleCli("getaddressutxos", "'[\"1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc\"]'")
+            + HelpExampleRpc("getaddressutxos", "[\"1PSSGeFHDnKNxiEyFrD1wcEaHr9hrQDDWc\"]")
+                },
+            }.Check(request);
+
+    const auto addresses = ParseAddresses(request.params[0]);
+    const AddressIndex& index = EnsureAddressIndex();
+
+    UniValue result(UniValue::VARR);
+    for (const auto& address : addresses) {
+        std::vector<CAddressUnspent> unspent;
+        if (!index.GetUnspent(address.second, unspent)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read unspent outputs for address " + address.first);
+        }
+        const std::string script_hex = HexStr(address.second.begin(), address.second.end());
+        for (const auto& entry : unspent) {
+            UniValue obj(UniValue::VOBJ);
+            obj.pushKV("address", address.first);
+            obj.pushKV("txid", entry.outpoint.hash.GetHex());
+            obj.pushKV("outputIndex", (int)entry.outpoint.n);
+            obj.pushKV("script", script_hex);
+            obj.pushKV("satoshis", entry.amount);
+            obj.pushKV("height", entry.height);
+            result.push_back(obj);
+        }
+    }
+    return result;
+}
+
+UniValue getspentinfo(const JSONRPCRequest& request)
+{
+            RPCHelpMan{"getspentinfo",
+                "\nReturns the txid and input index spending an output (requires -spentindex).\n",
+                {
+                    {"txid", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The hex string of the txid"},
+                    {"index", RPCArg::Type::NUM, RPCArg::Optional::NO, "The output index"},
+                },
+                RPCResult{
+            "{\n"
+            "  \"txid\": \"hash\",   (string) The spending transaction id\n"
+            "  \"index\": n,       (numeric) The spending input index\n"
+            "  \"height\": n       (numeric) The height of the block containing the spending transaction\n"
+            "}\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getspentinfo", "\"0437cd7f8525ceed2324359c2d0ba26006d92d856a9c20fa0241106ee5a597c9\" 0")
+            + HelpExampleRpc("getspentinfo", "\"0437cd7f8525ceed2324359c2d0ba26006d92d856a9c20fa0241106ee5a597c9\", 0")
+                },
+            }.Check(request);
+
+    const uint256 txid = ParseHashV(request.params[0], "txid");
+    const int n = request.params[1].get_int();
+    if (n < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid output index");
+    }
+
+    if (!g_spentindex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Spent index not enabled (start with -spentindex)");
+    }
+    const bool index_ready = g_spentindex->BlockUntilSyncedToCurrentChain();
+
+    CSpentIndexValue value;
+    if (!g_spentindex->FindSpent(COutPoint(txid, n), value)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, index_ready ? "Unable to get spent info" : "Unable to get spent info, spent index is still syncing");
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("txid", value.txid.GetHex());
+    result.pushKV("index", (int)value.input_index);
+    result.pushKV("height", value.height);
+    return result;
+}
+
 // clang-format off
 static const CRPCCommand commands[] =
 { //  category              name                      actor (function)         argNames
@@ -2315,7 +2696,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         {} },
     { "blockchain",         "getrawmempool",          &getrawmempool,          {"verbose"} },
     { "blockchain",         "gettxout",               &gettxout,               {"txid","n","include_mempool"} },
-    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {} },
+    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {"hash_type", "hash_or_height"} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        {"height"} },
     { "blockchain",         "savemempool",            &savemempool,            {} },
     { "blockchain",         "verifychain",            &verifychain,            {"checklevel","nblocks"} },
@@ -2324,6 +2705,12 @@ static const CRPCCommand commands[] =
     { "blockchain",         "scantxoutset",           &scantxoutset,           {"action", "scanobjects"} },
     { "blockchain",         "getblockfilter",         &getblockfilter,         {"blockhash", "filtertype"} },
 
+    { "addressindex",       "getaddressbalance",      &getaddressbalance,      {"addresses"} },
+    { "addressindex",       "getaddressdeltas",       &getaddressdeltas,       {"addresses", "start", "end"} },
+    { "addressindex",       "getaddresstxids",        &getaddresstxids,        {"addresses", "start", "end"} },
+    { "addressindex",       "getaddressutxos",        &getaddressutxos,        {"addresses"} },
+    { "addressindex",       "getspentinfo",           &getspentinfo,           {"txid", "index"} },
+
     /* Not shown in help */
     { "hidden",             "invalidateblock",        &invalidateblock,        {"blockhash"} },
     { "hidden",             "reconsiderblock",        &reconsiderblock,        {"blockhash"} },
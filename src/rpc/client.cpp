@@ -133,6 +133,12 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "importmulti", 1, "options" },
     { "verifychain", 0, "checklevel" },
     { "verifychain", 1, "nblocks" },
+    { "gettxoutsetinfo", 1, "hash_or_height" },
+    { "getaddressdeltas", 1, "start" },
+    { "getaddressdeltas", 2, "end" },
+    { "getaddresstxids", 1, "start" },
+    { "getaddresstxids", 2, "end" },
+    { "getspentinfo", 1, "index" },
     { "getblockstats", 0, "hash_or_height" },
     { "getblockstats", 1, "stats" },
     { "pruneblockchain", 0, "height" },
@@ -48,6 +48,82 @@ std::string JSONRPCReply(const UniValue& result, const UniValue& error, const Un
     return reply.write() + "\n";
 }
 
+namespace {
+/** Writes JSON like UniValue::write() without indentation, handing the output over in chunks. */
+class JSONChunkWriter
+{
+private:
+    const size_t m_chunk_size;
+    const std::function<void(std::string&&)>& m_sink;
+    std::string m_buffer;
+
+public:
+    JSONChunkWriter(size_t chunk_size, const std::function<void(std::string&&)>& sink) : m_chunk_size(chunk_size), m_sink(sink)
+    {
+        m_buffer.reserve(chunk_size);
+    }
+
+    void Append(const std::string& str)
+    {
+        m_buffer += str;
+        if (m_buffer.size() >= m_chunk_size) {
+            Flush();
+        }
+    }
+
+    void Write(const UniValue& value)
+    {
+        if (value.isObject()) {
+            const std::vector<std::string>& keys = value.getKeys();
+            const std::vector<UniValue>& values = value.getValues();
+            m_buffer += '{';
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (i > 0) m_buffer += ',';
+                // Let UniValue quote and escape the key
+                m_buffer += UniValue(keys[i]).write();
+                m_buffer += ':';
+                Write(values[i]);
+            }
+            m_buffer += '}';
+        } else if (value.isArray()) {
+            const std::vector<UniValue>& values = value.getValues();
+            m_buffer += '[';
+            for (size_t i = 0; i < values.size(); i++) {
+                if (i > 0) m_buffer += ',';
+                Write(values[i]);
+            }
+            m_buffer += ']';
+        } else {
+            m_buffer += value.write();
+        }
+        if (m_buffer.size() >= m_chunk_size) {
+            Flush();
+        }
+    }
+
+    void Flush()
+    {
+        if (m_buffer.empty()) return;
+        std::string chunk;
+        chunk.reserve(m_chunk_size);
+        chunk.swap(m_buffer);
+        m_sink(std::move(chunk));
+    }
+};
+} // namespace
+
+void JSONRPCReplyChunked(const UniValue& result, const UniValue& id, size_t chunk_size, const std::function<void(std::string&&)>& sink)
+{
+    // Same layout as JSONRPCReplyObj(result, NullUniValue, id).write() + "\n"
+    JSONChunkWriter writer(chunk_size, sink);
+    writer.Append("{\"result\":");
+    writer.Write(result);
+    writer.Append(",\"error\":null,\"id\":");
+    writer.Write(id);
+    writer.Append("}\n");
+    writer.Flush();
+}
+
 UniValue JSONRPCError(int code, const std::string& message)
 {
     UniValue error(UniValue::VOBJ);
@@ -6,6 +6,7 @@
 #ifndef BITCOIN_RPC_REQUEST_H
 #define BITCOIN_RPC_REQUEST_H
 
+#include <functional>
 #include <string>
 
 #include <univalue.h>
@@ -13,6 +14,12 @@
 UniValue JSONRPCRequestObj(const std::string& strMethod, const UniValue& params, const UniValue& id);
 UniValue JSONRPCReplyObj(const UniValue& result, const UniValue& error, const UniValue& id);
 std::string JSONRPCReply(const UniValue& result, const UniValue& error, const UniValue& id);
+/**
+ * Serialize the same reply as JSONRPCReply(result, NullUniValue, id) without copying result into a
+ * reply object or building the whole string: the output is passed to sink, in order, in pieces of
+ * about chunk_size bytes.
+ */
+void JSONRPCReplyChunked(const UniValue& result, const UniValue& id, size_t chunk_size, const std::function<void(std::string&&)>& sink);
 UniValue JSONRPCError(int code, const std::string& message);
 
 /** Generate a new RPC authentication cookie and write it to disk */
@@ -5,6 +5,7 @@
 #include "chainparams.h"
 #include "protocol.h"
 #include "rpc/rawtransaction_util.h"
+#include "rpc/rpcquorums.h"
 #include "rpc/server.h"
 #include "rpc/util.h"
 #include "server.h"
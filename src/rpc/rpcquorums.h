@@ -0,0 +1,15 @@
+// Copyright (c) 2019-2020 Zentoshi LLC
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_RPCQUORUMS_H
+#define BITCOIN_RPC_RPCQUORUMS_H
+
+#include <llmq/quorums.h>
+
+class UniValue;
+
+/** Quorum info as returned by the "quorum info" RPC. Also used by the REST interface. */
+UniValue BuildQuorumInfo(const llmq::CQuorumCPtr& quorum, bool includeMembers, bool includeSkShare);
+
+#endif // BITCOIN_RPC_RPCQUORUMS_H
@@ -13,9 +13,11 @@
 #include <netmessagemaker.h>
 #include <util/validation.h>
 
+#include <limits>
 #include <string>
 
 const std::string CSporkManager::SERIALIZATION_VERSION_STRING = "CSporkManager-Version-2";
+const int64_t CSporkManager::SPORK_VALUE_UNKNOWN = std::numeric_limits<int64_t>::min();
 
 #define MAKE_SPORK_DEF(name, defaultValue) CSporkDef{name, defaultValue, #name}
 std::vector<CSporkDef> sporkDefs = {
@@ -40,9 +42,14 @@ CSporkManager sporkManager;
 
 CSporkManager::CSporkManager()
 {
+    for (auto& value : sporkValues) {
+        value = SPORK_VALUE_UNKNOWN;
+    }
     for (auto& sporkDef : sporkDefs) {
         sporkDefsById.emplace(sporkDef.sporkId, &sporkDef);
         sporkDefsByName.emplace(sporkDef.name, &sporkDef);
+        assert(sporkDef.sporkId >= SPORK_2_INSTANTSEND_ENABLED && (size_t)(sporkDef.sporkId - SPORK_2_INSTANTSEND_ENABLED) < SPORK_VALUES_SIZE);
+        sporkValues[sporkDef.sporkId - SPORK_2_INSTANTSEND_ENABLED] = sporkDef.defaultValue;
     }
 }
 
@@ -67,11 +74,36 @@ bool CSporkManager::SporkValueIsActive(SporkId nSporkID, int64_t &nActiveValueRe
     return false;
 }
 
+void CSporkManager::UpdateSporkValue(SporkId nSporkID)
+{
+    AssertLockHeld(cs);
+
+    auto it = sporkDefsById.find(nSporkID);
+    if (it == sporkDefsById.end()) {
+        return;
+    }
+
+    int64_t nSporkValue;
+    if (!SporkValueIsActive(nSporkID, nSporkValue)) {
+        nSporkValue = it->second->defaultValue;
+    }
+    sporkValues[nSporkID - SPORK_2_INSTANTSEND_ENABLED] = nSporkValue;
+}
+
+void CSporkManager::UpdateSporkValues()
+{
+    LOCK(cs);
+    for (const auto& sporkDef : sporkDefs) {
+        UpdateSporkValue(sporkDef.sporkId);
+    }
+}
+
 void CSporkManager::Clear()
 {
     LOCK(cs);
     mapSporksActive.clear();
     mapSporksByHash.clear();
+    UpdateSporkValues();
 }
 
 void CSporkManager::CheckAndRemove()
@@ -120,6 +152,8 @@ void CSporkManager::CheckAndRemove()
         }
         ++itByHash;
     }
+
+    UpdateSporkValues();
 }
 
 void CSporkManager::ProcessSpork(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, CConnman& connman)
@@ -185,6 +219,7 @@ void CSporkManager::ProcessSpork(CNode* pfrom, const std::string& strCommand, CD
             LOCK(cs); // make sure to not lock this together with cs_main
             mapSporksByHash[hash] = spork;
             mapSporksActive[spork.nSporkID][keyIDSigner] = spork;
+            UpdateSporkValue(spork.nSporkID);
         }
         spork.Relay(connman);
 
@@ -221,6 +256,7 @@ bool CSporkManager::UpdateSpork(SporkId nSporkID, int64_t nValue, CConnman& conn
 
     mapSporksByHash[spork.GetHash()] = spork;
     mapSporksActive[nSporkID][keyIDSigner] = spork;
+    UpdateSporkValue(nSporkID);
 
     spork.Relay(connman);
     return true;
@@ -234,16 +270,11 @@ bool CSporkManager::IsSporkActive(SporkId nSporkID)
 
 int64_t CSporkManager::GetSporkValue(SporkId nSporkID)
 {
-    LOCK(cs);
-
-    int64_t nSporkValue = -1;
-    if (SporkValueIsActive(nSporkID, nSporkValue)) {
-        return nSporkValue;
-    }
-
-    auto it = sporkDefsById.find(nSporkID);
-    if (it != sporkDefsById.end()) {
-        return it->second->defaultValue;
+    if (nSporkID >= SPORK_2_INSTANTSEND_ENABLED && (size_t)(nSporkID - SPORK_2_INSTANTSEND_ENABLED) < SPORK_VALUES_SIZE) {
+        int64_t nSporkValue = sporkValues[nSporkID - SPORK_2_INSTANTSEND_ENABLED].load(std::memory_order_relaxed);
+        if (nSporkValue != SPORK_VALUE_UNKNOWN) {
+            return nSporkValue;
+        }
     }
 
     LogPrint(BCLog::SPORK, "CSporkManager::GetSporkValue -- Unknown Spork ID %d\n", nSporkID);
@@ -303,6 +334,7 @@ bool CSporkManager::SetMinSporkKeys(int minSporkKeys)
         return false;
     }
     nMinSporkKeys = minSporkKeys;
+    UpdateSporkValues();
     return true;
 }
 
@@ -11,6 +11,9 @@
 #include "util/strencodings.h"
 #include "key.h"
 
+#include <array>
+#include <atomic>
+#include <limits>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -170,15 +173,34 @@ private:
     std::unordered_map<SporkId, std::map<CKeyID, CSporkMessage> > mapSporksActive;
 
     std::set<CKeyID> setSporkPubKeyIDs;
-    int nMinSporkKeys;
+    int nMinSporkKeys{std::numeric_limits<int>::max()};
     CKey sporkPrivKey;
 
+    static const size_t SPORK_VALUES_SIZE = SPORK_30_ZENTOSHI_RESERVED3 - SPORK_2_INSTANTSEND_ENABLED + 1;
+    static const int64_t SPORK_VALUE_UNKNOWN;
+
+    /**
+     * Current value of every spork, indexed by nSporkID - SPORK_2_INSTANTSEND_ENABLED.
+     *
+     * Values are resolved whenever the set of active spork messages changes, so that
+     * GetSporkValue (which is called for every transaction and block) is a single atomic
+     * load instead of taking cs and tallying the signers. Unused IDs hold SPORK_VALUE_UNKNOWN.
+     */
+    std::array<std::atomic<int64_t>, SPORK_VALUES_SIZE> sporkValues;
+
     /**
      * SporkValueIsActive is used to get the value agreed upon by the majority
      * of signed spork messages for a given Spork ID.
      */
     bool SporkValueIsActive(SporkId nSporkID, int64_t& nActiveValueRet) const;
 
+    /**
+     * UpdateSporkValue recalculates the published value of a spork from the active
+     * spork messages. UpdateSporkValues does so for all sporks.
+     */
+    void UpdateSporkValue(SporkId nSporkID);
+    void UpdateSporkValues();
+
 public:
 
     CSporkManager();
@@ -203,6 +225,9 @@ public:
         READWRITE(mapSporksByHash);
         READWRITE(mapSporksActive);
         // we don't serialize private key to prevent its leakage
+        if (ser_action.ForRead()) {
+            UpdateSporkValues();
+        }
     }
 
     /**
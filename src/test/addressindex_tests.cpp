@@ -0,0 +1,142 @@
+// Copyright (c) 2019-2020 Zentoshi LLC
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/addressindex.h>
+#include <index/spentindex.h>
+#include <script/interpreter.h>
+#include <script/standard.h>
+#include <test/setup_common.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(addressindex_initial_sync, TestChain100Setup)
+{
+    AddressIndex address_index(1 << 20, true);
+    SpentIndex spent_index(1 << 20, true);
+
+    CScript coinbase_script = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+
+    // BlockUntilSyncedToCurrentChain should return false before the indexes are started.
+    BOOST_CHECK(!address_index.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(!spent_index.BlockUntilSyncedToCurrentChain());
+
+    address_index.Start();
+    spent_index.Start();
+
+    // Allow the indexes to catch up with the block index.
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!address_index.BlockUntilSyncedToCurrentChain() || !spent_index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+
+    // Every coinbase of the test chain pays to the coinbase script.
+    std::vector<CAddressUnspent> unspent;
+    BOOST_CHECK(address_index.GetUnspent(coinbase_script, unspent));
+    BOOST_CHECK_EQUAL(unspent.size(), m_coinbase_txns.size());
+
+    CAmount balance, received;
+    BOOST_CHECK(address_index.GetBalance(coinbase_script, balance, received));
+    BOOST_CHECK_EQUAL(balance, received);
+    BOOST_CHECK(balance > 0);
+
+    // The coinbases pay to the key directly, they are found by the address of the key as well.
+    CScript coinbase_address_script = GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
+    CAmount address_balance, address_received;
+    BOOST_CHECK(address_index.GetBalance(coinbase_address_script, address_balance, address_received));
+    BOOST_CHECK_EQUAL(address_balance, balance);
+    BOOST_CHECK_EQUAL(address_received, received);
+    std::vector<CAddressUnspent> address_unspent;
+    BOOST_CHECK(address_index.GetUnspent(coinbase_address_script, address_unspent));
+    BOOST_CHECK_EQUAL(address_unspent.size(), m_coinbase_txns.size());
+
+    std::vector<CAddressDelta> deltas;
+    BOOST_CHECK(address_index.GetDeltas(coinbase_script, 0, -1, deltas));
+    BOOST_CHECK_EQUAL(deltas.size(), m_coinbase_txns.size());
+    BOOST_CHECK(address_index.GetDeltas(coinbase_script, 1, 10, deltas));
+    BOOST_CHECK_EQUAL(deltas.size(), 10U);
+    for (const auto& delta : deltas) {
+        BOOST_CHECK(!delta.spending);
+        BOOST_CHECK(delta.height >= 1 && delta.height <= 10);
+    }
+
+    // Spend the first coinbase to a new key and check that both indexes follow.
+    CKey key;
+    key.MakeNewKey(true);
+    CScript dest_script = GetScriptForDestination(PKHash(key.GetPubKey()));
+
+    const CTransactionRef& prev_tx = m_coinbase_txns[0];
+    const CAmount prev_value = prev_tx->vout[0].nValue;
+    CMutableTransaction spend;
+    spend.nVersion = 1;
+    spend.vin.resize(1);
+    spend.vin[0].prevout = COutPoint(prev_tx->GetHash(), 0);
+    spend.vout.resize(1);
+    spend.vout[0].nValue = prev_value - CENT;
+    spend.vout[0].scriptPubKey = dest_script;
+
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(coinbase_script, spend, 0, SIGHASH_ALL, 0, SigVersion::BASE);
+    BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+
+    CBlock block = CreateAndProcessBlock({spend}, coinbase_script);
+    int spend_height;
+    {
+        LOCK(cs_main);
+        BOOST_REQUIRE(::ChainActive().Tip()->GetBlockHash() == block.GetHash());
+        spend_height = ::ChainActive().Height();
+    }
+    BOOST_CHECK(address_index.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(spent_index.BlockUntilSyncedToCurrentChain());
+
+    CSpentIndexValue spent;
+    BOOST_CHECK(spent_index.FindSpent(spend.vin[0].prevout, spent));
+    BOOST_CHECK(spent.txid == spend.GetHash());
+    BOOST_CHECK_EQUAL(spent.input_index, 0U);
+    BOOST_CHECK_EQUAL(spent.height, spend_height);
+    BOOST_CHECK(!spent_index.FindSpent(COutPoint(spend.GetHash(), 0), spent));
+
+    CAmount dest_balance, dest_received;
+    BOOST_CHECK(address_index.GetBalance(dest_script, dest_balance, dest_received));
+    BOOST_CHECK_EQUAL(dest_balance, prev_value - CENT);
+    BOOST_CHECK_EQUAL(dest_received, prev_value - CENT);
+    BOOST_CHECK(address_index.GetUnspent(dest_script, unspent));
+    BOOST_REQUIRE_EQUAL(unspent.size(), 1U);
+    BOOST_CHECK(unspent[0].outpoint == COutPoint(spend.GetHash(), 0));
+    BOOST_CHECK_EQUAL(unspent[0].height, spend_height);
+
+    // The spent coinbase is gone from the unspent set and shows up as a spending delta.
+    BOOST_CHECK(address_index.GetUnspent(coinbase_script, unspent));
+    for (const auto& coin : unspent) {
+        BOOST_CHECK(coin.outpoint != spend.vin[0].prevout);
+    }
+    BOOST_CHECK(address_index.GetDeltas(coinbase_script, spend_height, spend_height, deltas));
+    bool found_spending = false;
+    for (const auto& delta : deltas) {
+        if (delta.spending) {
+            found_spending = true;
+            BOOST_CHECK(delta.txid == spend.GetHash());
+            BOOST_CHECK_EQUAL(delta.amount, -prev_value);
+        }
+    }
+    BOOST_CHECK(found_spending);
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    address_index.Stop();
+    spent_index.Stop();
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+
+    // Rest of shutdown sequence and destructors happen in ~TestingSetup()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
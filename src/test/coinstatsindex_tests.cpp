@@ -0,0 +1,95 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/coinstatsindex.h>
+#include <node/coinstats.h>
+#include <script/standard.h>
+#include <test/setup_common.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(coinstatsindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(coinstatsindex_initial_sync, TestChain100Setup)
+{
+    CoinStatsIndex coin_stats_index{1 << 20, true};
+
+    CCoinsStats coin_stats;
+    const CBlockIndex* block_index;
+    {
+        LOCK(cs_main);
+        block_index = ::ChainActive().Tip();
+    }
+
+    // Stats should not be found in the index before it is started.
+    BOOST_CHECK(!coin_stats_index.LookUpStats(block_index, coin_stats));
+
+    // BlockUntilSyncedToCurrentChain should return false before index is started.
+    BOOST_CHECK(!coin_stats_index.BlockUntilSyncedToCurrentChain());
+
+    coin_stats_index.Start();
+
+    // Allow the index to catch up with the block index.
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!coin_stats_index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+
+    // Check that the stats of the genesis block and the tip can be looked up.
+    const CBlockIndex* genesis_block_index;
+    {
+        LOCK(cs_main);
+        genesis_block_index = ::ChainActive().Genesis();
+    }
+    BOOST_CHECK(coin_stats_index.LookUpStats(genesis_block_index, coin_stats));
+    BOOST_CHECK_EQUAL(coin_stats.nTransactionOutputs, 0U);
+    BOOST_CHECK(coin_stats_index.LookUpStats(block_index, coin_stats));
+
+    // The index must agree with a full scan of the chainstate.
+    CCoinsStats scan_stats;
+    ::ChainstateActive().ForceFlushStateToDisk();
+    CCoinsView* coins_view = WITH_LOCK(cs_main, return &::ChainstateActive().CoinsDB());
+    BOOST_CHECK(GetUTXOStats(coins_view, scan_stats, CoinStatsHashType::MUHASH));
+    BOOST_CHECK(!scan_stats.from_index);
+    BOOST_CHECK_EQUAL(coin_stats.hashSerialized.GetHex(), scan_stats.hashSerialized.GetHex());
+    BOOST_CHECK_EQUAL(coin_stats.nTransactionOutputs, scan_stats.nTransactionOutputs);
+    BOOST_CHECK_EQUAL(coin_stats.nBogoSize, scan_stats.nBogoSize);
+    BOOST_CHECK_EQUAL(coin_stats.nTotalAmount, scan_stats.nTotalAmount);
+
+    // Create a new block and check that the index follows it.
+    CScript script_pub_key = GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
+    std::vector<CMutableTransaction> noTxns;
+    CreateAndProcessBlock(noTxns, script_pub_key);
+
+    const CBlockIndex* new_block_index;
+    {
+        LOCK(cs_main);
+        new_block_index = ::ChainActive().Tip();
+    }
+    BOOST_CHECK(coin_stats_index.BlockUntilSyncedToCurrentChain());
+
+    CCoinsStats new_coin_stats;
+    BOOST_CHECK(coin_stats_index.LookUpStats(new_block_index, new_coin_stats));
+    BOOST_CHECK(coin_stats.hashSerialized != new_coin_stats.hashSerialized);
+    BOOST_CHECK(new_coin_stats.nTransactionOutputs > coin_stats.nTransactionOutputs);
+
+    // Historical entries stay available.
+    CCoinsStats old_coin_stats;
+    BOOST_CHECK(coin_stats_index.LookUpStats(block_index, old_coin_stats));
+    BOOST_CHECK_EQUAL(old_coin_stats.hashSerialized.GetHex(), coin_stats.hashSerialized.GetHex());
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    coin_stats_index.Stop();
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+
+    // Rest of shutdown sequence and destructors happen in ~TestingSetup()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <arith_uint256.h>
 #include <dbwrapper.h>
 #include <uint256.h>
 #include <test/setup_common.h>
@@ -119,6 +120,73 @@ BOOST_AUTO_TEST_CASE(dbwrapper_iterator)
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_transaction)
+{
+    fs::path ph = GetDataDir() / "dbwrapper_transaction";
+    CDBWrapper dbw(ph, (1 << 20), true, false, false);
+    CDBBatch batch(dbw);
+    CDBTransaction<CDBWrapper, CDBBatch> dbTx(dbw, batch);
+
+    uint256 in = InsecureRand256();
+    uint256 in2 = InsecureRand256();
+    uint256 res;
+    std::string str_res;
+    BOOST_CHECK(dbw.Write('d', in));
+
+    dbTx.Write('a', in);
+    dbTx.Write('b', in);
+    // overwrite with the same type and with another type
+    dbTx.Write('a', in2);
+    dbTx.Write('b', std::string("b"));
+    dbTx.Erase('d');
+    BOOST_CHECK(dbTx.GetMemoryUsage() > 0);
+
+    BOOST_CHECK(dbTx.Read('a', res));
+    BOOST_CHECK_EQUAL(res.ToString(), in2.ToString());
+    BOOST_CHECK(dbTx.Read('b', str_res));
+    BOOST_CHECK_EQUAL(str_res, "b");
+    BOOST_CHECK_THROW(dbTx.Read('b', res), std::runtime_error);
+    BOOST_CHECK(!dbTx.Exists('d'));
+    BOOST_CHECK(dbw.Exists('d'));
+
+    // enough entries to need several arena blocks
+    for (uint32_t i = 0; i < 10000; i++) {
+        dbTx.Write(std::make_pair('x', i), ArithToUint256(i));
+    }
+    for (uint32_t i = 0; i < 10000; i++) {
+        BOOST_CHECK(dbTx.Read(std::make_pair('x', i), res));
+        BOOST_CHECK(res == ArithToUint256(i));
+    }
+
+    // the iterator merges the pending writes with the parent, in key order
+    auto it = dbTx.NewIteratorUniquePtr();
+    it->SeekToFirst();
+    char key_res;
+    BOOST_REQUIRE(it->GetKey(key_res));
+    BOOST_CHECK_EQUAL(key_res, 'a');
+    it->Next();
+    BOOST_REQUIRE(it->GetKey(key_res));
+    BOOST_CHECK_EQUAL(key_res, 'b');
+    it->Next();
+    std::pair<char, uint32_t> pair_res;
+    BOOST_REQUIRE(it->GetKey(pair_res));
+    BOOST_CHECK(pair_res == std::make_pair('x', (uint32_t)0));
+    it.reset();
+
+    dbTx.Commit();
+    BOOST_CHECK(dbTx.IsClean());
+    BOOST_CHECK(!dbTx.Read('a', res));
+    BOOST_CHECK(dbw.WriteBatch(batch));
+
+    BOOST_CHECK(dbw.Read('a', res));
+    BOOST_CHECK_EQUAL(res.ToString(), in2.ToString());
+    BOOST_CHECK(dbw.Read('b', str_res));
+    BOOST_CHECK_EQUAL(str_res, "b");
+    BOOST_CHECK(!dbw.Exists('d'));
+    BOOST_CHECK(dbw.Read(std::make_pair('x', (uint32_t)9999), res));
+    BOOST_CHECK(res == ArithToUint256(9999));
+}
+
 // Test that we do not obfuscation if there is existing data.
 BOOST_AUTO_TEST_CASE(existing_data_no_obfuscate)
 {
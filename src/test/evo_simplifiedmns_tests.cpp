@@ -0,0 +1,151 @@
+// Copyright (c) 2019-2020 Zentoshi LLC
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <evo/deterministicmns.h>
+#include <evo/simplifiedmns.h>
+#include <hash.h>
+#include <netbase.h>
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(evo_simplifiedmns_tests, BasicTestingSetup)
+
+static CDeterministicMNCPtr CreateTestMN(uint64_t internalId)
+{
+    auto state = std::make_shared<CDeterministicMNState>();
+    uint256 ownerSeed = InsecureRand256();
+    state->keyIDOwner = CKeyID(Hash160(ownerSeed.begin(), ownerSeed.end()));
+    state->confirmedHash = InsecureRand256();
+    if (InsecureRandBool()) {
+        // the port keeps the address unique within the list
+        state->addr = LookupNumeric("1.2.3.4", 10000 + internalId);
+    }
+
+    auto dmn = std::make_shared<CDeterministicMN>();
+    dmn->proTxHash = InsecureRand256();
+    dmn->internalId = internalId;
+    dmn->collateralOutpoint = COutPoint(InsecureRand256(), 0);
+    dmn->nOperatorReward = 0;
+    dmn->pdmnState = state;
+    return dmn;
+}
+
+static void UpdateTestMN(CDeterministicMNList& mnList, const CDeterministicMNCPtr& dmn)
+{
+    auto state = std::make_shared<CDeterministicMNState>(*dmn->pdmnState);
+    switch (InsecureRandRange(4)) {
+    case 0:
+        state->confirmedHash = InsecureRand256();
+        break;
+    case 1:
+        state->nPoSeBanHeight = state->nPoSeBanHeight == -1 ? (int)InsecureRandRange(1000) : -1;
+        break;
+    case 2: {
+        uint256 votingSeed = InsecureRand256();
+        state->keyIDVoting = CKeyID(Hash160(votingSeed.begin(), votingSeed.end()));
+        break;
+    }
+    default:
+        // not part of the SML entry, the leaf must stay untouched
+        state->nLastPaidHeight++;
+        break;
+    }
+    mnList.UpdateMN(dmn, state);
+}
+
+static void CheckTree(const CSimplifiedMNListMerkleTree& tree, const CDeterministicMNList& mnList)
+{
+    bool mutatedExpected = true;
+    uint256 rootExpected = CSimplifiedMNList(mnList).CalcMerkleRoot(&mutatedExpected);
+    // every leaf commits to a distinct proRegTxHash, so a duplicated last node must never count as mutation
+    BOOST_CHECK(!mutatedExpected);
+
+    bool mutated = true;
+    BOOST_CHECK_EQUAL(tree.GetMerkleRoot(&mutated).ToString(), rootExpected.ToString());
+    BOOST_CHECK_EQUAL(mutated, mutatedExpected);
+    BOOST_CHECK_EQUAL(tree.GetLeafCount(), mnList.GetAllMNsCount());
+
+    CSimplifiedMNListMerkleTree rebuilt;
+    rebuilt.Build(mnList);
+    mutated = true;
+    BOOST_CHECK_EQUAL(rebuilt.GetMerkleRoot(&mutated).ToString(), rootExpected.ToString());
+    BOOST_CHECK_EQUAL(mutated, mutatedExpected);
+}
+
+static void ApplyAndCheck(CSimplifiedMNListMerkleTree& tree, CDeterministicMNList& mnList, const CDeterministicMNList& newList)
+{
+    auto diff = mnList.BuildDiff(newList);
+    tree.ApplyDiff(mnList, newList, diff);
+    mnList = newList;
+    CheckTree(tree, mnList);
+}
+
+BOOST_AUTO_TEST_CASE(merkle_tree_grow_shrink)
+{
+    // Walk the list through every small size, so that both odd and even leaf counts (where the
+    // last node of a level is paired with itself) are hit on the way up and on the way down
+    CDeterministicMNList mnList(uint256(), 0, 0);
+    CSimplifiedMNListMerkleTree tree;
+    tree.Build(mnList);
+    CheckTree(tree, mnList);
+
+    std::vector<uint256> proTxHashes;
+    for (uint64_t i = 0; i < 9; i++) {
+        CDeterministicMNList newList = mnList;
+        auto dmn = CreateTestMN(i);
+        newList.AddMN(dmn);
+        proTxHashes.emplace_back(dmn->proTxHash);
+        ApplyAndCheck(tree, mnList, newList);
+    }
+    while (!proTxHashes.empty()) {
+        size_t idx = InsecureRandRange(proTxHashes.size());
+        CDeterministicMNList newList = mnList;
+        newList.RemoveMN(proTxHashes[idx]);
+        proTxHashes.erase(proTxHashes.begin() + idx);
+        ApplyAndCheck(tree, mnList, newList);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(merkle_tree_random_diffs)
+{
+    CDeterministicMNList mnList(uint256(), 0, 0);
+    CSimplifiedMNListMerkleTree tree;
+    tree.Build(mnList);
+
+    std::vector<uint256> proTxHashes;
+    uint64_t nextInternalId = 0;
+    for (int step = 0; step < 300; step++) {
+        CDeterministicMNList newList = mnList;
+        newList.SetHeight(step + 1);
+
+        // A diff may mix additions, removals and updates, or contain only updates, which takes
+        // the UpdatePath shortcut instead of rebuilding the inner levels
+        size_t nAdd = InsecureRandRange(3);
+        size_t nRemove = proTxHashes.empty() ? 0 : InsecureRandRange(std::min<size_t>(proTxHashes.size(), 2) + 1);
+        size_t nUpdate = proTxHashes.empty() ? 0 : InsecureRandRange(4);
+        if (InsecureRandBool()) {
+            nAdd = nRemove = 0;
+        }
+
+        for (size_t i = 0; i < nRemove; i++) {
+            size_t idx = InsecureRandRange(proTxHashes.size());
+            newList.RemoveMN(proTxHashes[idx]);
+            proTxHashes.erase(proTxHashes.begin() + idx);
+        }
+        for (size_t i = 0; i < nUpdate && !proTxHashes.empty(); i++) {
+            auto dmn = newList.GetMN(proTxHashes[InsecureRandRange(proTxHashes.size())]);
+            UpdateTestMN(newList, dmn);
+        }
+        for (size_t i = 0; i < nAdd; i++) {
+            auto dmn = CreateTestMN(nextInternalId++);
+            newList.AddMN(dmn);
+            proTxHashes.emplace_back(dmn->proTxHash);
+        }
+
+        ApplyAndCheck(tree, mnList, newList);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,131 @@
+// Copyright (c) 2019-2020 Zentoshi LLC
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <net.h>
+#include <net_processing.h>
+#include <protocol.h>
+#include <streams.h>
+#include <util/time.h>
+#include <version.h>
+
+#include <test/setup_common.h>
+
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+/** Handler which records the processed commands and blocks until the gate is opened. */
+struct BlockingHandler {
+    std::promise<void> gate;
+    std::shared_future<void> opened{gate.get_future().share()};
+    std::mutex mutex;
+    std::vector<std::string> commands;
+
+    ExtensionMessageQueue::Handler Get()
+    {
+        return [this](CNode* pfrom, const std::string& strCommand, CDataStream& vRecv) {
+            opened.wait();
+            std::lock_guard<std::mutex> lock(mutex);
+            commands.push_back(strCommand);
+        };
+    }
+};
+
+CDataStream MakeMessage(size_t size)
+{
+    CDataStream ds(SER_NETWORK, PROTOCOL_VERSION);
+    ds.resize(size);
+    return ds;
+}
+
+void WaitForDrain(ExtensionMessageQueue& queue, NodeId nodeid)
+{
+    for (int i = 0; i < 1000 && queue.GetQueuedBytes(nodeid) != 0; i++) {
+        MilliSleep(10);
+    }
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(extensionmessagequeue_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(byte_accounting_and_backlog)
+{
+    const size_t header_size = CMessageHeader::HEADER_SIZE;
+    CAddress addr;
+    CNode node1(0, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "", true);
+    CNode node2(1, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "", true);
+
+    BlockingHandler handler;
+    // a single worker, so both peers share a queue
+    ExtensionMessageQueue queue(g_connman.get(), 1, handler.Get());
+
+    // every message is accounted with its header, right up to the cut-off
+    BOOST_CHECK(queue.Push(&node1, "first", MakeMessage(1000)));
+    BOOST_CHECK_EQUAL(queue.GetQueuedBytes(node1.GetId()), 1000 + header_size);
+    BOOST_CHECK(queue.Push(&node1, "second", MakeMessage(MAX_MN_MSG_QUEUE_BYTES - 1000 - 2 * header_size)));
+    BOOST_CHECK_EQUAL(queue.GetQueuedBytes(node1.GetId()), MAX_MN_MSG_QUEUE_BYTES);
+    BOOST_CHECK(!queue.IsBacklogged(node1.GetId()));
+    BOOST_CHECK_EQUAL(node1.GetRefCount(), 2);
+
+    // crossing MAX_MN_MSG_QUEUE_BYTES only backlogs this peer
+    BOOST_CHECK(queue.Push(&node1, "third", MakeMessage(0)));
+    BOOST_CHECK_EQUAL(queue.GetQueuedBytes(node1.GetId()), MAX_MN_MSG_QUEUE_BYTES + header_size);
+    BOOST_CHECK(queue.IsBacklogged(node1.GetId()));
+    BOOST_CHECK(queue.Push(&node2, "other", MakeMessage(10)));
+    BOOST_CHECK_EQUAL(queue.GetQueuedBytes(node2.GetId()), 10 + header_size);
+    BOOST_CHECK(!queue.IsBacklogged(node2.GetId()));
+
+    // once processed, all bytes and node references are released again
+    handler.gate.set_value();
+    WaitForDrain(queue, node1.GetId());
+    WaitForDrain(queue, node2.GetId());
+    BOOST_CHECK_EQUAL(queue.GetQueuedBytes(node1.GetId()), 0U);
+    BOOST_CHECK_EQUAL(queue.GetQueuedBytes(node2.GetId()), 0U);
+    BOOST_CHECK(!queue.IsBacklogged(node1.GetId()));
+    BOOST_CHECK_EQUAL(node1.GetRefCount(), 0);
+    BOOST_CHECK_EQUAL(node2.GetRefCount(), 0);
+
+    {
+        std::lock_guard<std::mutex> lock(handler.mutex);
+        const std::vector<std::string> expected{"first", "second", "third", "other"};
+        BOOST_CHECK(handler.commands == expected);
+    }
+
+    queue.Stop();
+    BOOST_CHECK(!queue.Push(&node1, "late", MakeMessage(10)));
+    BOOST_CHECK_EQUAL(queue.GetQueuedBytes(node1.GetId()), 0U);
+    BOOST_CHECK_EQUAL(node1.GetRefCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(stop_drops_queued_messages)
+{
+    CAddress addr;
+    CNode node(0, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "", true);
+
+    BlockingHandler handler;
+    ExtensionMessageQueue queue(g_connman.get(), 1, handler.Get());
+    for (int i = 0; i < 3; i++) {
+        BOOST_CHECK(queue.Push(&node, "msg", MakeMessage(MAX_MN_MSG_QUEUE_BYTES / 2)));
+    }
+    BOOST_CHECK(queue.IsBacklogged(node.GetId()));
+
+    // the worker is stuck in the handler, let it return while Stop is waiting for it
+    std::thread opener([&handler] {
+        MilliSleep(50);
+        handler.gate.set_value();
+    });
+    queue.Stop();
+    opener.join();
+
+    BOOST_CHECK_EQUAL(queue.GetQueuedBytes(node.GetId()), 0U);
+    BOOST_CHECK(!queue.IsBacklogged(node.GetId()));
+    BOOST_CHECK_EQUAL(node.GetRefCount(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
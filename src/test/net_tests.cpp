@@ -303,5 +303,23 @@ BOOST_AUTO_TEST_CASE(LocalAddress_BasicLifecycle)
     BOOST_CHECK_EQUAL(IsLocal(addr), false);
 }
 
+BOOST_AUTO_TEST_CASE(socket_events_mode)
+{
+    SocketEventsMode mode;
+    BOOST_CHECK(ParseSocketEventsMode(SocketEventsModeToString(DEFAULT_SOCKETEVENTS), mode));
+    BOOST_CHECK(mode == DEFAULT_SOCKETEVENTS);
+
+    BOOST_CHECK(ParseSocketEventsMode("select", mode));
+    BOOST_CHECK(mode == SocketEventsMode::Select);
+#ifdef USE_EPOLL
+    BOOST_CHECK(ParseSocketEventsMode("epoll", mode));
+    BOOST_CHECK(mode == SocketEventsMode::EPoll);
+#else
+    BOOST_CHECK(!ParseSocketEventsMode("epoll", mode));
+#endif
+    BOOST_CHECK(!ParseSocketEventsMode("kqueue", mode));
+    BOOST_CHECK(!ParseSocketEventsMode("", mode));
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
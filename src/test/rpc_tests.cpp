@@ -233,6 +233,42 @@ BOOST_AUTO_TEST_CASE(json_parse_errors)
     BOOST_CHECK_THROW(ParseNonRFCJSONValue("3J98t1WpEZ73CNmQviecrnyiWrnqRhWNL"), std::runtime_error);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_reply_chunked)
+{
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("str", "a \"quoted\"\n string");
+    result.pushKV("esc\tkey", 1.5);
+    result.pushKV("null", NullUniValue);
+    UniValue arr(UniValue::VARR);
+    for (int i = 0; i < 100; i++) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("n", i);
+        entry.pushKV("odd", i % 2 == 1);
+        entry.pushKV("empty", UniValue(UniValue::VARR));
+        arr.push_back(entry);
+    }
+    result.pushKV("arr", arr);
+    const UniValue id("someid");
+
+    const std::string expected = JSONRPCReply(result, NullUniValue, id);
+    for (size_t chunk_size : {1, 7, 64, 1 << 20}) {
+        std::string reply;
+        size_t chunks = 0;
+        JSONRPCReplyChunked(result, id, chunk_size, [&](std::string&& chunk) {
+            BOOST_CHECK(!chunk.empty());
+            reply += chunk;
+            chunks++;
+        });
+        BOOST_CHECK_EQUAL(reply, expected);
+        BOOST_CHECK(chunk_size < expected.size() ? chunks > 1 : chunks == 1);
+    }
+
+    // Scalar results and ids
+    std::string reply;
+    JSONRPCReplyChunked(UniValue(42), NullUniValue, 16, [&](std::string&& chunk) { reply += chunk; });
+    BOOST_CHECK_EQUAL(reply, JSONRPCReply(UniValue(42), NullUniValue, NullUniValue));
+}
+
 BOOST_AUTO_TEST_CASE(rpc_ban)
 {
     BOOST_CHECK_NO_THROW(CallRPC(std::string("clearbanned")));
@@ -339,6 +375,20 @@ BOOST_AUTO_TEST_CASE(rpc_convert_values_generatetoaddress)
     BOOST_CHECK_EQUAL(result[2].get_int(), 9);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_convert_values_getaddress)
+{
+    UniValue result;
+
+    // a plain address must not be parsed as JSON, the address index RPCs accept it as a string
+    BOOST_CHECK_NO_THROW(result = RPCConvertValues("getaddressbalance", {"mkESjLZW66TmHhiFX8MCaBjrhZ543PPh9a"}));
+    BOOST_CHECK_EQUAL(result[0].get_str(), "mkESjLZW66TmHhiFX8MCaBjrhZ543PPh9a");
+
+    BOOST_CHECK_NO_THROW(result = RPCConvertValues("getaddressdeltas", {"[\"mkESjLZW66TmHhiFX8MCaBjrhZ543PPh9a\"]", "1000", "2000"}));
+    BOOST_CHECK_EQUAL(result[0].get_str(), "[\"mkESjLZW66TmHhiFX8MCaBjrhZ543PPh9a\"]");
+    BOOST_CHECK_EQUAL(result[1].get_int(), 1000);
+    BOOST_CHECK_EQUAL(result[2].get_int(), 2000);
+}
+
 BOOST_AUTO_TEST_CASE(rpc_getblockstats_calculate_percentiles_by_weight)
 {
     int64_t total_weight = 200;
@@ -80,6 +80,8 @@ BOOST_AUTO_TEST_CASE(getlocator_test)
         int r = InsecureRandRange(150000);
         CBlockIndex* tip = (r < 100000) ? &vBlocksMain[r] : &vBlocksSide[r - 100000];
         CBlockLocator locator = chain.GetLocator(tip);
+        // The skiplist only locator must not depend on whether the block is in the chain.
+        BOOST_CHECK(GetLocator(tip).vHave == locator.vHave);
 
         // The first result must be the block itself, the last one must be genesis.
         BOOST_CHECK(locator.vHave.front() == tip->GetBlockHash());
@@ -41,6 +41,12 @@ static const int64_t nMaxBlockDBCache = 2;
 static const int64_t nMaxTxIndexCache = 1024;
 //! Max memory allocated to all block filter index caches combined in MiB.
 static const int64_t max_filter_index_cache = 1024;
+//! Max memory allocated to the coin stats index cache in MiB.
+static const int64_t max_coinstats_index_cache = 8;
+//! Max memory allocated to the address index cache in MiB.
+static const int64_t max_address_index_cache = 1024;
+//! Max memory allocated to the spent index cache in MiB.
+static const int64_t max_spent_index_cache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
 
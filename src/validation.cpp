@@ -62,6 +62,7 @@
 #include <future>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/join.hpp>
@@ -1921,6 +1922,57 @@ void ThreadScriptCheck(int worker_num) {
     scriptcheckqueue.Thread();
 }
 
+static CCheckQueue<CInputPrefetch> inputprefetchqueue(128);
+
+void ThreadInputPrefetch(int worker_num) {
+    util::ThreadRename(strprintf("zentoshi-inpfetch.%i", worker_num));
+    inputprefetchqueue.Thread();
+}
+
+/** Minimum number of uncached inputs for which a block's coins are read in parallel */
+static const size_t MIN_PARALLEL_INPUT_PREFETCH = 16;
+
+void CChainState::PrefetchInputs(const CBlock& block, const CCoinsViewCache& view)
+{
+    CCoinsViewCache& coins_tip = CoinsTip();
+
+    std::unordered_set<uint256, SaltedTxidHasher> block_txids;
+    block_txids.reserve(block.vtx.size());
+    for (const auto& tx : block.vtx) {
+        block_txids.insert(tx->GetHash());
+    }
+
+    // Outputs created in this block and coins already in memory need no disk access.
+    std::vector<COutPoint> outpoints;
+    for (const auto& tx : block.vtx) {
+        if (tx->IsCoinBase()) continue;
+        for (const CTxIn& txin : tx->vin) {
+            if (block_txids.count(txin.prevout.hash) || view.HaveCoinInCache(txin.prevout) || coins_tip.HaveCoinInCache(txin.prevout)) {
+                continue;
+            }
+            outpoints.push_back(txin.prevout);
+        }
+    }
+    if (outpoints.size() < MIN_PARALLEL_INPUT_PREFETCH) {
+        return;
+    }
+
+    // Each check writes to its own slot, and Wait() synchronizes with the workers.
+    std::vector<Coin> coins(outpoints.size());
+    std::vector<CInputPrefetch> checks;
+    checks.reserve(outpoints.size());
+    for (size_t i = 0; i < outpoints.size(); ++i) {
+        checks.emplace_back(&CoinsErrorCatcher(), outpoints[i], &coins[i]);
+    }
+    CCheckQueueControl<CInputPrefetch> control(&inputprefetchqueue);
+    control.Add(checks);
+    control.Wait();
+
+    for (size_t i = 0; i < outpoints.size(); ++i) {
+        coins_tip.WarmCoin(outpoints[i], std::move(coins[i]));
+    }
+}
+
 VersionBitsCache versionbitscache GUARDED_BY(cs_main);
 
 int32_t ComputeBlockVersion(const CBlockIndex* pindexPrev, const Consensus::Params& params)
@@ -2034,6 +2086,7 @@ static unsigned int GetBlockScriptFlags(const CBlockIndex* pindex, const Consens
 
 static int64_t nTimeCheck = 0;
 static int64_t nTimeForks = 0;
+static int64_t nTimePrefetch = 0;
 static int64_t nTimeVerify = 0;
 static int64_t nTimeISFilter = 0;
 static int64_t nTimePayeeAndSpecial = 0;
@@ -2247,6 +2300,15 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
     int64_t nTime2 = GetTimeMicros(); nTimeForks += nTime2 - nTime1;
     LogPrint(BCLog::BNCH, "    - Fork checks: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime2 - nTime1), nTimeForks * MICRO, nTimeForks * MILLI / nBlocksTotal);
 
+    // Read the coins this block spends from disk in parallel, so that the
+    // serial input checks below find them in memory.
+    if (nScriptCheckThreads) {
+        PrefetchInputs(block, view);
+    }
+
+    int64_t nTime2_1 = GetTimeMicros(); nTimePrefetch += nTime2_1 - nTime2;
+    LogPrint(BCLog::BNCH, "    - Prefetch inputs: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime2_1 - nTime2), nTimePrefetch * MICRO, nTimePrefetch * MILLI / nBlocksTotal);
+
     CBlockUndo blockundo;
 
     CCheckQueueControl<CScriptCheck> control(fScriptChecks && nScriptCheckThreads ? &scriptcheckqueue : nullptr);
@@ -2347,13 +2409,12 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
 
     }
 
-    int64_t nTime3 = GetTimeMicros(); nTimeConnect += nTime3 - nTime2;
-    LogPrint(BCLog::BNCH, "      - Connect %u transactions: %.2fms (%.3fms/tx, %.3fms/txin) [%.2fs]\n", (unsigned)block.vtx.size(), 0.001 * (nTime3 - nTime2), 0.001 * (nTime3 - nTime2) / block.vtx.size(), nInputs <= 1 ? 0 : 0.001 * (nTime3 - nTime2) / (nInputs-1), nTimeConnect * 0.000001);
+    int64_t nTime3 = GetTimeMicros(); nTimeConnect += nTime3 - nTime2_1;
+    LogPrint(BCLog::BNCH, "      - Connect %u transactions: %.2fms (%.3fms/tx, %.3fms/txin) [%.2fs]\n", (unsigned)block.vtx.size(), 0.001 * (nTime3 - nTime2_1), 0.001 * (nTime3 - nTime2_1) / block.vtx.size(), nInputs <= 1 ? 0 : 0.001 * (nTime3 - nTime2_1) / (nInputs-1), nTimeConnect * 0.000001);
 
-    if (!control.Wait())
-        return state.Invalid(ValidationInvalidReason::CONSENSUS, error("%s: CheckQueue failed", __func__), REJECT_INVALID, "block-validation-failed");
-    int64_t nTime4 = GetTimeMicros(); nTimeVerify += nTime4 - nTime2;
-    LogPrint(BCLog::BNCH, "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs]\n", nInputs - 1, 0.001 * (nTime4 - nTime2), nInputs <= 1 ? 0 : 0.001 * (nTime4 - nTime2) / (nInputs-1), nTimeVerify * 0.000001);
+    // ZENTOSHI: The checks below do not depend on the validity of the block's
+    // scripts, so they run while the script check threads verify the inputs
+    // queued above. Only state changing processing waits for control.Wait().
 
     /// ZENTOSHI: Check superblock start
 
@@ -2392,8 +2453,8 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
         LogPrintf("ConnectBlock(ZENTOSHI): spork is off, skipping transaction locking checks\n");
     }
 
-    int64_t nTime5_1 = GetTimeMicros(); nTimeISFilter += nTime5_1 - nTime4;
-    LogPrint(BCLog::BNCH, "      - IS filter: %.2fms [%.2fs]\n", 0.001 * (nTime5_1 - nTime4), nTimeISFilter * 0.000001);
+    int64_t nTime3_1 = GetTimeMicros(); nTimeISFilter += nTime3_1 - nTime3;
+    LogPrint(BCLog::BNCH, "      - IS filter: %.2fms [%.2fs]\n", 0.001 * (nTime3_1 - nTime3), nTimeISFilter * 0.000001);
 
     // ZENTOSHI : CHECK MASTERNODE PAYMENTS AND SUPERBLOCKS
 
@@ -2436,13 +2497,25 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
                                   REJECT_INVALID, "bad-cb-payee");
     }
 
+    // Check DIP0003/CBTX transactions
+    if (!CheckSpecialTxsInBlock(block, pindex, state, fScriptChecks)) {
+        return false;
+    }
+
+    int64_t nTime3_2 = GetTimeMicros();
+
+    if (!control.Wait())
+        return state.Invalid(ValidationInvalidReason::CONSENSUS, error("%s: CheckQueue failed", __func__), REJECT_INVALID, "block-validation-failed");
+    int64_t nTime4 = GetTimeMicros(); nTimeVerify += nTime4 - nTime2;
+    LogPrint(BCLog::BNCH, "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs]\n", nInputs - 1, 0.001 * (nTime4 - nTime2), nInputs <= 1 ? 0 : 0.001 * (nTime4 - nTime2) / (nInputs-1), nTimeVerify * 0.000001);
+
     // Process DIP0003/CBTX transactions
-    if (!ProcessSpecialTxsInBlock(block, pindex, state, fJustCheck, fScriptChecks)) {
+    if (!ProcessSpecialTxsInBlock(block, pindex, state, fJustCheck)) {
         return false;
     }
 
-    int64_t nTime5 = GetTimeMicros(); nTimePayeeAndSpecial += nTime5 - nTime4;
-    LogPrint(BCLog::BNCH, "    - Payee and special txes: %.2fms [%.2fs]\n", 0.001 * (nTime5 - nTime4), nTimePayeeAndSpecial * 0.000001);
+    int64_t nTime5 = GetTimeMicros(); nTimePayeeAndSpecial += (nTime3_2 - nTime3_1) + (nTime5 - nTime4);
+    LogPrint(BCLog::BNCH, "    - Payee and special txes: %.2fms [%.2fs]\n", 0.001 * ((nTime3_2 - nTime3_1) + (nTime5 - nTime4)), nTimePayeeAndSpecial * 0.000001);
 
     // END ZENTOSHI
 
@@ -122,6 +122,9 @@ static const int64_t MAX_FEE_ESTIMATION_TIP_AGE = 3 * 60 * 60;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
 static const bool DEFAULT_TXINDEX = true;
 static const char* const DEFAULT_BLOCKFILTERINDEX = "0";
+static const bool DEFAULT_COINSTATSINDEX = false;
+static const bool DEFAULT_ADDRESSINDEX = false;
+static const bool DEFAULT_SPENTINDEX = false;
 static const unsigned int DEFAULT_BANSCORE_THRESHOLD = 100;
 /** Default for -persistmempool */
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
@@ -271,6 +274,8 @@ bool LoadBlockIndex(const CChainParams& chainparams) EXCLUSIVE_LOCKS_REQUIRED(cs
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck(int worker_num);
+/** Run an instance of the input prefetching thread */
+void ThreadInputPrefetch(int worker_num);
 /** Retrieve a transaction (from memory pool, or from disk, if possible) */
 bool GetTransaction(const uint256& hash, CTransactionRef& tx, const Consensus::Params& params, uint256& hashBlock, const CBlockIndex* const blockIndex = nullptr);
 bool GetTransaction(const uint256& hash, CTransactionRef& txOut, const Consensus::Params& consensusParams, uint256& hashBlock, bool unused);
@@ -387,6 +392,37 @@ public:
     ScriptError GetScriptError() const { return error; }
 };
 
+/**
+ * Closure reading one coin spent by a block from the UTXO database, so that
+ * the coins of a block can be fetched in parallel before it is connected.
+ */
+class CInputPrefetch
+{
+private:
+    const CCoinsView* m_view;
+    COutPoint m_outpoint;
+    Coin* m_coin;
+
+public:
+    CInputPrefetch(): m_view(nullptr), m_coin(nullptr) {}
+    CInputPrefetch(const CCoinsView* viewIn, const COutPoint& outpointIn, Coin* coinIn) :
+        m_view(viewIn), m_outpoint(outpointIn), m_coin(coinIn) { }
+
+    bool operator()() {
+        // A missing coin is not an error here; ConnectBlock reports it when checking the inputs.
+        if (!m_view->GetCoin(m_outpoint, *m_coin)) {
+            m_coin->Clear();
+        }
+        return true;
+    }
+
+    void swap(CInputPrefetch &check) {
+        std::swap(m_view, check.m_view);
+        std::swap(m_outpoint, check.m_outpoint);
+        std::swap(m_coin, check.m_coin);
+    }
+};
+
 /** Initializes the script-execution cache */
 void InitScriptExecutionCache();
 
@@ -769,6 +805,9 @@ private:
 
     bool RollforwardBlock(const CBlockIndex* pindex, CCoinsViewCache& inputs, const CChainParams& params) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    //! Load the coins spent by a block that are not cached yet into CoinsTip(), reading them from disk in parallel
+    void PrefetchInputs(const CBlock& block, const CCoinsViewCache& view) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
     //! Mark a block as not having block data
     void EraseBlockData(CBlockIndex* index) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 };
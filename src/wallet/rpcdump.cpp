@@ -201,6 +201,9 @@ UniValue importprivkey(const JSONRPCRequest& request)
             if (pubkey.IsCompressed()) {
                 pwallet->ImportScripts({GetScriptForDestination(WitnessV0KeyHash(vchAddress))}, 0 /* timestamp */);
             }
+
+            // Outputs of transactions already in the wallet may be ours now, a rescan doesn't revisit unconfirmed ones
+            pwallet->RebuildWalletUTXO(*locked_chain);
         }
     }
     if (fRescan) {
@@ -327,6 +330,8 @@ UniValue importaddress(const JSONRPCRequest& request)
         } else {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid Zentoshi address or script");
         }
+
+        pwallet->RebuildWalletUTXO(*locked_chain);
     }
     if (fRescan)
     {
@@ -433,7 +438,7 @@ UniValue removeprunedfunds(const JSONRPCRequest& request)
     vHash.push_back(hash);
     std::vector<uint256> vHashOut;
 
-    if (pwallet->ZapSelectTx(vHash, vHashOut) != DBErrors::LOAD_OK) {
+    if (pwallet->ZapSelectTx(*locked_chain, vHash, vHashOut) != DBErrors::LOAD_OK) {
         throw JSONRPCError(RPC_WALLET_ERROR, "Could not properly delete the transaction.");
     }
 
@@ -517,6 +522,8 @@ UniValue importpubkey(const JSONRPCRequest& request)
         pwallet->ImportScriptPubKeys(strLabel, script_pub_keys, true /* have_solving_data */, true /* apply_label */, 1 /* timestamp */);
 
         pwallet->ImportPubKeys({pubKey.GetID()}, {{pubKey.GetID(), pubKey}} , {} /* key_origins */, false /* add_keypool */, false /* internal */, 1 /* timestamp */);
+
+        pwallet->RebuildWalletUTXO(*locked_chain);
     }
     if (fRescan)
     {
@@ -683,6 +690,11 @@ UniValue importwallet(const JSONRPCRequest& request)
     pwallet->chain().showProgress("", 100, false); // hide progress dialog in GUI
     RescanWallet(*pwallet, reserver, nTimeBegin, false /* update */);
     pwallet->MarkDirty();
+    {
+        auto locked_chain = pwallet->chain().lock();
+        LOCK(pwallet->cs_wallet);
+        pwallet->RebuildWalletUTXO(*locked_chain);
+    }
 
     if (!fGood)
         throw JSONRPCError(RPC_WALLET_ERROR, "Error adding some keys/scripts to wallet");
@@ -1408,6 +1420,8 @@ UniValue importmulti(const JSONRPCRequest& mainRequest)
                 nLowestTimestamp = timestamp;
             }
         }
+
+        pwallet->RebuildWalletUTXO(*locked_chain);
     }
     if (fRescan && fRunScan && requests.size()) {
         int64_t scannedTime = pwallet->RescanFromTime(nLowestTimestamp, reserver, true /* update */);
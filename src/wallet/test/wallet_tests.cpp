@@ -9,8 +9,12 @@
 #include <vector>
 
 #include <consensus/validation.h>
+#include <evo/deterministicmns.h>
+#include <evo/evodb.h>
 #include <interfaces/chain.h>
+#include <key_io.h>
 #include <policy/policy.h>
+#include <privatesend/privatesend.h>
 #include <rpc/server.h>
 #include <test/setup_common.h>
 #include <validation.h>
@@ -21,6 +25,7 @@
 #include <univalue.h>
 
 extern UniValue importmulti(const JSONRPCRequest& request);
+extern UniValue importprivkey(const JSONRPCRequest& request);
 extern UniValue dumpwallet(const JSONRPCRequest& request);
 extern UniValue importwallet(const JSONRPCRequest& request);
 
@@ -460,6 +465,154 @@ BOOST_FIXTURE_TEST_CASE(ListCoins, ListCoinsTestingSetup)
     BOOST_CHECK_EQUAL(list.begin()->second.size(), 2U);
 }
 
+/** AddToWallet checks new outputs against the masternode list, which needs the evo DB and the deterministic MN manager. */
+class WalletEvoTestingSetup : public WalletTestingSetup
+{
+public:
+    WalletEvoTestingSetup()
+    {
+        evoDb = new CEvoDB(1 << 20, true, true);
+        deterministicMNManager = new CDeterministicMNManager(*evoDb);
+        CPrivateSend::InitStandardDenominations();
+    }
+
+    ~WalletEvoTestingSetup()
+    {
+        delete deterministicMNManager;
+        deterministicMNManager = nullptr;
+        delete evoDb;
+        evoDb = nullptr;
+    }
+
+    /** Add a transaction spending prevout with a single output to script. */
+    CTransactionRef AddTx(const COutPoint& prevout, const CScript& script, CAmount value)
+    {
+        CMutableTransaction mtx;
+        mtx.vin.emplace_back(prevout);
+        mtx.vout.emplace_back(value, script);
+        CTransactionRef tx = MakeTransactionRef(mtx);
+        BOOST_CHECK(m_wallet.AddToWallet(CWalletTx(&m_wallet, tx)));
+        return tx;
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(privatesend_rounds_cache, WalletEvoTestingSetup)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    AddKey(m_wallet, key);
+    const CScript script = GetScriptForDestination(PKHash(key.GetPubKey()));
+    const CAmount denom = COIN + 1000;
+
+    // The parent is not known yet, so the child starts a new chain of rounds
+    CMutableTransaction parent;
+    parent.vin.emplace_back(COutPoint(InsecureRand256(), 0));
+    parent.vout.emplace_back(denom, script);
+    CTransactionRef child = AddTx(COutPoint(parent.GetHash(), 0), script, denom);
+    CTransactionRef grandchild = AddTx(COutPoint(child->GetHash(), 0), script, denom);
+    BOOST_CHECK_EQUAL(m_wallet.GetRealOutpointPrivateSendRounds(COutPoint(child->GetHash(), 0)), 0);
+    BOOST_CHECK_EQUAL(m_wallet.GetRealOutpointPrivateSendRounds(COutPoint(grandchild->GetHash(), 0)), 1);
+
+    // Adding the transaction creating the spent outpoint drops the cached rounds of all descendants
+    BOOST_CHECK(m_wallet.AddToWallet(CWalletTx(&m_wallet, MakeTransactionRef(parent))));
+    BOOST_CHECK_EQUAL(m_wallet.GetRealOutpointPrivateSendRounds(COutPoint(parent.GetHash(), 0)), 0);
+    BOOST_CHECK_EQUAL(m_wallet.GetRealOutpointPrivateSendRounds(COutPoint(child->GetHash(), 0)), 1);
+    BOOST_CHECK_EQUAL(m_wallet.GetRealOutpointPrivateSendRounds(COutPoint(grandchild->GetHash(), 0)), 2);
+
+    // And so does removing it again
+    {
+        auto locked_chain = m_chain->lock();
+        LOCK(m_wallet.cs_wallet);
+        std::vector<uint256> hashes{parent.GetHash()}, removed;
+        BOOST_CHECK(m_wallet.ZapSelectTx(*locked_chain, hashes, removed) == DBErrors::LOAD_OK);
+        BOOST_CHECK_EQUAL(removed.size(), 1U);
+    }
+    BOOST_CHECK_EQUAL(m_wallet.GetRealOutpointPrivateSendRounds(COutPoint(child->GetHash(), 0)), 0);
+    BOOST_CHECK_EQUAL(m_wallet.GetRealOutpointPrivateSendRounds(COutPoint(grandchild->GetHash(), 0)), 1);
+
+    // Outputs which are not denominated are never counted as mixed
+    CTransactionRef change = AddTx(COutPoint(grandchild->GetHash(), 0), script, denom - 1);
+    BOOST_CHECK_EQUAL(m_wallet.GetRealOutpointPrivateSendRounds(COutPoint(change->GetHash(), 0)), -2);
+}
+
+static CTransactionRef AddConfirmedTx(CWallet& wallet, const COutPoint& prevout, const std::vector<CTxOut>& outputs)
+{
+    CMutableTransaction mtx;
+    mtx.vin.emplace_back(prevout);
+    mtx.vout = outputs;
+    CTransactionRef tx = MakeTransactionRef(mtx);
+    CWalletTx wtx(&wallet, tx);
+    {
+        LOCK(cs_main);
+        wtx.SetConf(CWalletTx::Status::CONFIRMED, ::ChainActive().Genesis()->GetBlockHash(), 0);
+    }
+    BOOST_CHECK(wallet.AddToWallet(wtx));
+    return tx;
+}
+
+static std::vector<COutPoint> AvailableOutpoints(CWallet& wallet)
+{
+    auto locked_chain = wallet.chain().lock();
+    LOCK(wallet.cs_wallet);
+    std::vector<COutput> coins;
+    wallet.AvailableCoins(*locked_chain, coins);
+    std::vector<COutPoint> result;
+    for (const auto& coin : coins) {
+        result.emplace_back(coin.tx->GetHash(), coin.i);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+BOOST_FIXTURE_TEST_CASE(wallet_utxo_set, WalletEvoTestingSetup)
+{
+    auto wallet = std::make_shared<CWallet>(m_chain.get(), WalletLocation(), WalletDatabase::CreateMock());
+    bool firstRun;
+    wallet->LoadWallet(firstRun);
+
+    CKey key, imported_key;
+    key.MakeNewKey(true);
+    imported_key.MakeNewKey(true);
+    AddKey(*wallet, key);
+    const CScript script = GetScriptForDestination(PKHash(key.GetPubKey()));
+    const CScript imported_script = GetScriptForDestination(PKHash(imported_key.GetPubKey()));
+    CKey other_key;
+    other_key.MakeNewKey(true);
+    const CScript other_script = GetScriptForDestination(PKHash(other_key.GetPubKey()));
+
+    // Adding a transaction only adds the outputs which are ours
+    CTransactionRef tx = AddConfirmedTx(*wallet, COutPoint(InsecureRand256(), 0), {CTxOut(COIN, script), CTxOut(2 * COIN, imported_script)});
+    const COutPoint ours(tx->GetHash(), 0), imported(tx->GetHash(), 1);
+    BOOST_CHECK(AvailableOutpoints(*wallet) == std::vector<COutPoint>{ours});
+
+    // Spending it removes it
+    CTransactionRef spend = AddConfirmedTx(*wallet, ours, {CTxOut(COIN / 2, other_script)});
+    BOOST_CHECK(AvailableOutpoints(*wallet).empty());
+
+    // Zapping the spending transaction makes it available again
+    {
+        auto locked_chain = m_chain->lock();
+        LOCK(wallet->cs_wallet);
+        std::vector<uint256> hashes{spend->GetHash()}, removed;
+        BOOST_CHECK(wallet->ZapSelectTx(*locked_chain, hashes, removed) == DBErrors::LOAD_OK);
+        BOOST_CHECK_EQUAL(removed.size(), 1U);
+    }
+    BOOST_CHECK(AvailableOutpoints(*wallet) == std::vector<COutPoint>{ours});
+
+    // Importing a key without a rescan picks up the outputs of known transactions paying to it
+    AddWallet(wallet);
+    JSONRPCRequest request;
+    request.params.setArray();
+    request.params.push_back(EncodeSecret(imported_key));
+    request.params.push_back("");
+    request.params.push_back(false);
+    importprivkey(request);
+    RemoveWallet(wallet);
+    std::vector<COutPoint> expected{ours, imported};
+    std::sort(expected.begin(), expected.end());
+    BOOST_CHECK(AvailableOutpoints(*wallet) == expected);
+}
+
 BOOST_FIXTURE_TEST_CASE(wallet_disableprivkeys, TestChain100Setup)
 {
     auto chain = interfaces::MakeChain();
@@ -866,6 +866,31 @@ bool CWallet::IsSpent(interfaces::Chain::Lock& locked_chain, const uint256& hash
     return false;
 }
 
+void CWallet::UpdateWalletUTXO(interfaces::Chain::Lock& locked_chain, const COutPoint& outpoint)
+{
+    AssertLockHeld(cs_wallet);
+    auto it = mapWallet.find(outpoint.hash);
+    if (it != mapWallet.end() && outpoint.n < it->second.tx->vout.size() &&
+        IsMine(it->second.tx->vout[outpoint.n]) && !IsSpent(locked_chain, outpoint.hash, outpoint.n)) {
+        setWalletUTXO.insert(outpoint);
+    } else {
+        setWalletUTXO.erase(outpoint);
+    }
+}
+
+void CWallet::RebuildWalletUTXO(interfaces::Chain::Lock& locked_chain)
+{
+    AssertLockHeld(cs_wallet);
+    setWalletUTXO.clear();
+    for (const auto& pair : mapWallet) {
+        for (unsigned int i = 0; i < pair.second.tx->vout.size(); ++i) {
+            if (IsMine(pair.second.tx->vout[i]) && !IsSpent(locked_chain, pair.first, i)) {
+                setWalletUTXO.insert(COutPoint(pair.first, i));
+            }
+        }
+    }
+}
+
 void CWallet::AddToSpends(const COutPoint& outpoint, const uint256& wtxid)
 {
     mapTxSpends.insert(std::make_pair(outpoint, wtxid));
@@ -1060,9 +1085,33 @@ void CWallet::MarkDirty()
         LOCK(cs_wallet);
         for (std::pair<const uint256, CWalletTx>& item : mapWallet)
             item.second.MarkDirty();
+        // Keys or transactions changed, which inputs are ours may have too
+        mapOutpointRoundsCache.clear();
+        InvalidateBalanceCache();
     }
 }
 
+CWallet::BalanceCache& CWallet::GetBalanceCache(interfaces::Chain::Lock& locked_chain) const
+{
+    AssertLockHeld(cs_wallet);
+    const Optional<int> tip_height = locked_chain.getHeight();
+    const uint256 tip = tip_height ? locked_chain.getBlockHash(*tip_height) : uint256();
+    if (tip != m_balance_cache.tip) {
+        // Depths changed, so trust and maturity of every transaction may have too
+        m_balance_cache = BalanceCache();
+        m_balance_cache.tip = tip;
+    }
+    return m_balance_cache;
+}
+
+void CWallet::InvalidateBalanceCache()
+{
+    AssertLockHeld(cs_wallet);
+    const uint256 tip = m_balance_cache.tip;
+    m_balance_cache = BalanceCache();
+    m_balance_cache.tip = tip;
+}
+
 bool CWallet::MarkReplaced(const uint256& originalHash, const uint256& newHash)
 {
     LOCK(cs_wallet);
@@ -1106,6 +1155,7 @@ void CWallet::SetUsedDestinationState(const uint256& hash, unsigned int n, bool
             } else if (!used && GetDestData(dst, "used", nullptr)) {
                 EraseDestData(dst, "used");
             }
+            InvalidateBalanceCache();
         }
     }
 }
@@ -1165,6 +1215,7 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
         wtx.m_it_wtxOrdered = wtxOrdered.insert(std::make_pair(wtx.nOrderPos, &wtx));
         wtx.nTimeSmart = ComputeTimeSmart(wtx);
         AddToSpends(hash);
+        InvalidatePrivateSendRounds(hash);
 
         auto mnList = deterministicMNManager->GetListAtChainTip();
         for (unsigned int i = 0; i < wtx.tx->vout.size(); ++i) {
@@ -1173,6 +1224,10 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
                 if (deterministicMNManager->IsProTxWithCollateral(wtx.tx, i) || mnList.HasMNByCollateral(COutPoint(hash, i))) {
                     LockCoin(COutPoint(hash, i));
                 }
+                // Parents are usually cached already, so this is a lookup per input
+                if (CPrivateSend::IsDenominatedAmount(wtx.tx->vout[i].nValue)) {
+                    GetRealOutpointPrivateSendRounds(COutPoint(hash, i));
+                }
             }
         }
     }
@@ -1205,6 +1260,17 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
         }
     }
 
+    if (!fInsertedNew) {
+        // Outputs may have become ours since (e.g. after an import), and the inputs may be
+        // spent again if this transaction was conflicted or abandoned before
+        for (unsigned int i = 0; i < wtx.tx->vout.size(); ++i) {
+            UpdateWalletUTXO(*locked_chain, COutPoint(hash, i));
+        }
+        for (const CTxIn& txin : wtx.tx->vin) {
+            UpdateWalletUTXO(*locked_chain, txin.prevout);
+        }
+    }
+
     //// debug print
     WalletLogPrintf("AddToWallet %s  %s%s\n", wtxIn.GetHash().ToString(), (fInsertedNew ? "new" : ""), (fUpdated ? "update" : ""));
 
@@ -1215,6 +1281,7 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
 
     // Break debit/credit balance caches:
     wtx.MarkDirty();
+    InvalidateBalanceCache();
 
     // Notify UI of new or updated transaction
     NotifyTransactionChanged(this, hash, fInsertedNew ? CT_NEW : CT_UPDATED);
@@ -1255,6 +1322,7 @@ void CWallet::LoadToWallet(CWalletTx& wtxIn)
         wtx.m_it_wtxOrdered = wtxOrdered.insert(std::make_pair(wtx.nOrderPos, &wtx));
     }
     AddToSpends(hash);
+    InvalidateBalanceCache();
     for (const CTxIn& txin : wtx.tx->vin) {
         auto it = mapWallet.find(txin.prevout.hash);
         if (it != mapWallet.end()) {
@@ -1339,6 +1407,7 @@ void CWallet::MarkInputsDirty(const CTransactionRef& tx)
             it->second.MarkDirty();
         }
     }
+    InvalidateBalanceCache();
 }
 
 bool CWallet::AbandonTransaction(interfaces::Chain::Lock& locked_chain, const uint256& hashTx)
@@ -1391,6 +1460,9 @@ bool CWallet::AbandonTransaction(interfaces::Chain::Lock& locked_chain, const ui
             // If a transaction changes 'conflicted' state, that changes the balance
             // available of the outputs it spends. So force those to be recomputed
             MarkInputsDirty(wtx.tx);
+            for (const CTxIn& txin : wtx.tx->vin) {
+                UpdateWalletUTXO(locked_chain, txin.prevout);
+            }
         }
     }
 
@@ -1445,6 +1517,9 @@ void CWallet::MarkConflicted(const uint256& hashBlock, const uint256& hashTx)
             // If a transaction changes 'conflicted' state, that changes the balance
             // available of the outputs it spends. So force those to be recomputed
             MarkInputsDirty(wtx.tx);
+            for (const CTxIn& txin : wtx.tx->vin) {
+                UpdateWalletUTXO(*locked_chain, txin.prevout);
+            }
         }
     }
 }
@@ -1468,6 +1543,7 @@ void CWallet::TransactionAddedToMempool(const CTransactionRef& ptx) {
     auto it = mapWallet.find(ptx->GetHash());
     if (it != mapWallet.end()) {
         it->second.fInMempool = true;
+        InvalidateBalanceCache();
     }
     fAnonymizableTallyCached = false;
     fAnonymizableTallyCachedNonDenom = false;
@@ -1478,6 +1554,7 @@ void CWallet::TransactionRemovedFromMempool(const CTransactionRef &ptx) {
     auto it = mapWallet.find(ptx->GetHash());
     if (it != mapWallet.end()) {
         it->second.fInMempool = false;
+        InvalidateBalanceCache();
     }
 }
 
@@ -1546,7 +1623,7 @@ isminetype CWallet::IsMine(const CTxIn &txin) const
 
 int CWallet::GetRealOutpointPrivateSendRounds(const COutPoint& outpoint, int nRounds) const
 {
-    static std::map<uint256, CMutableTransaction> mDenomWtxes;
+    LOCK(cs_wallet);
 
     if (nRounds >= 16) return 15; // 16 rounds max
 
@@ -1554,71 +1631,84 @@ int CWallet::GetRealOutpointPrivateSendRounds(const COutPoint& outpoint, int nRo
     unsigned int nout = outpoint.n;
 
     const CWalletTx* wtx = GetWalletTx(hash);
-    if (wtx != NULL) {
-        std::map<uint256, CMutableTransaction>::const_iterator mdwi = mDenomWtxes.find(hash);
-        if (mdwi == mDenomWtxes.end()) {
-            // not known yet, let's add it
-            LogPrint(BCLog::PRIVATESEND, "GetRealOutpointPrivateSendRounds INSERTING %s\n", hash.ToString());
-            mDenomWtxes[hash] = CMutableTransaction(*wtx->tx);
-        } else if (mDenomWtxes[hash].vout[nout].nRounds != -10) {
-            // found and it's not an initial value, just return it
-            return mDenomWtxes[hash].vout[nout].nRounds;
-        }
-
-
-        // bounds check
-        if (nout >= wtx->tx->vout.size()) {
-            // should never actually hit this
-            LogPrint(BCLog::PRIVATESEND, "GetRealOutpointPrivateSendRounds UPDATED   %s %3d %3d\n", hash.ToString(), nout, -4);
-            return -4;
-        }
+    if (wtx == nullptr) {
+        return nRounds - 1;
+    }
 
-        if (CPrivateSend::IsCollateralAmount(wtx->tx->vout[nout].nValue)) {
-            mDenomWtxes[hash].vout[nout].nRounds = -3;
-            LogPrint(BCLog::PRIVATESEND, "GetRealOutpointPrivateSendRounds UPDATED   %s %3d %3d\n", hash.ToString(), nout, mDenomWtxes[hash].vout[nout].nRounds);
-            return mDenomWtxes[hash].vout[nout].nRounds;
-        }
+    auto it = mapOutpointRoundsCache.find(outpoint);
+    if (it != mapOutpointRoundsCache.end()) {
+        return it->second;
+    }
 
+    int nResult;
+    // bounds check
+    if (nout >= wtx->tx->vout.size()) {
+        // should never actually hit this
+        nResult = -4;
+    } else if (CPrivateSend::IsCollateralAmount(wtx->tx->vout[nout].nValue)) {
+        nResult = -3;
+    } else if (!CPrivateSend::IsDenominatedAmount(wtx->tx->vout[nout].nValue)) {
         //make sure the final output is non-denominate
-        if (!CPrivateSend::IsDenominatedAmount(wtx->tx->vout[nout].nValue)) { //NOT DENOM
-            mDenomWtxes[hash].vout[nout].nRounds = -2;
-            LogPrint(BCLog::PRIVATESEND, "GetRealOutpointPrivateSendRounds UPDATED   %s %3d %3d\n", hash.ToString(), nout, mDenomWtxes[hash].vout[nout].nRounds);
-            return mDenomWtxes[hash].vout[nout].nRounds;
-        }
-
+        nResult = -2;
+    } else {
         bool fAllDenoms = true;
-        for (CTxOut out : wtx->tx->vout) {
+        for (const CTxOut& out : wtx->tx->vout) {
             fAllDenoms = fAllDenoms && CPrivateSend::IsDenominatedAmount(out.nValue);
         }
 
-        // this one is denominated but there is another non-denominated output found in the same tx
         if (!fAllDenoms) {
-            mDenomWtxes[hash].vout[nout].nRounds = 0;
-            LogPrint(BCLog::PRIVATESEND, "GetRealOutpointPrivateSendRounds UPDATED   %s %3d %3d\n", hash.ToString(), nout, mDenomWtxes[hash].vout[nout].nRounds);
-            return mDenomWtxes[hash].vout[nout].nRounds;
-        }
-
-        int nShortest = -10; // an initial value, should be no way to get this by calculations
-        bool fDenomFound = false;
-        // only denoms here so let's look up
-        for (CTxIn txinNext : wtx->tx->vin) {
-            if (IsMine(txinNext)) {
-                int n = GetRealOutpointPrivateSendRounds(txinNext.prevout, nRounds + 1);
-                // denom found, find the shortest chain or initially assign nShortest with the first found value
-                if (n >= 0 && (n < nShortest || nShortest == -10)) {
-                    nShortest = n;
-                    fDenomFound = true;
+            // this one is denominated but there is another non-denominated output found in the same tx
+            nResult = 0;
+        } else {
+            int nShortest = -10; // an initial value, should be no way to get this by calculations
+            bool fDenomFound = false;
+            // only denoms here so let's look up
+            for (const CTxIn& txinNext : wtx->tx->vin) {
+                if (IsMine(txinNext)) {
+                    int n = GetRealOutpointPrivateSendRounds(txinNext.prevout, nRounds + 1);
+                    // denom found, find the shortest chain or initially assign nShortest with the first found value
+                    if (n >= 0 && (n < nShortest || nShortest == -10)) {
+                        nShortest = n;
+                        fDenomFound = true;
+                    }
                 }
             }
+            nResult = fDenomFound ? (nShortest >= 15 ? 16 : nShortest + 1) // good, we a +1 to the shortest one but only 16 rounds max allowed
+                                  : 0; // too bad, we are the fist one in that chain
         }
-        mDenomWtxes[hash].vout[nout].nRounds = fDenomFound ? (nShortest >= 15 ? 16 : nShortest + 1) // good, we a +1 to the shortest one but only 16 rounds max allowed
-                                                             :
-                                                             0; // too bad, we are the fist one in that chain
-        LogPrint(BCLog::PRIVATESEND, "GetRealOutpointPrivateSendRounds UPDATED   %s %3d %3d\n", hash.ToString(), nout, mDenomWtxes[hash].vout[nout].nRounds);
-        return mDenomWtxes[hash].vout[nout].nRounds;
     }
 
-    return nRounds - 1;
+    LogPrint(BCLog::PRIVATESEND, "GetRealOutpointPrivateSendRounds UPDATED   %s %3d %3d\n", hash.ToString(), nout, nResult);
+    mapOutpointRoundsCache.emplace(outpoint, nResult);
+    return nResult;
+}
+
+void CWallet::InvalidatePrivateSendRounds(const uint256& txid)
+{
+    AssertLockHeld(cs_wallet);
+
+    InvalidateBalanceCache();
+    if (mapOutpointRoundsCache.empty()) return;
+
+    // The rounds of an outpoint depend on which of its transaction's inputs are in the wallet.
+    // When a parent shows up after its descendants were cached (rescans, out of order relay),
+    // drop the cached rounds of everything spending from it.
+    std::vector<uint256> vToVisit{txid};
+    std::set<uint256> setVisited{txid};
+    while (!vToVisit.empty()) {
+        const uint256 hash = vToVisit.back();
+        vToVisit.pop_back();
+        for (auto it = mapTxSpends.lower_bound(COutPoint(hash, 0)); it != mapTxSpends.end() && it->first.hash == hash; ++it) {
+            const uint256& spender = it->second;
+            if (!setVisited.insert(spender).second) continue;
+            auto first = mapOutpointRoundsCache.lower_bound(COutPoint(spender, 0));
+            auto last = first;
+            while (last != mapOutpointRoundsCache.end() && last->first.hash == spender) ++last;
+            if (first == last) continue; // nothing cached below this transaction
+            mapOutpointRoundsCache.erase(first, last);
+            vToVisit.push_back(spender);
+        }
+    }
 }
 
 int CWallet::GetOutpointPrivateSendRounds(const COutPoint& outpoint) const
@@ -2259,6 +2349,7 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
         progress_end = chain().guessVerificationProgress(stop_block.IsNull() ? tip_hash : stop_block);
     }
     double progress_current = progress_begin;
+    std::unique_ptr<interfaces::Chain::BlockReader> block_reader = chain().makeBlockReader();
     while (block_height && !fAbortRescan && !chain().shutdownRequested()) {
         m_scanning_progress = (progress_current - progress_begin) / (progress_end - progress_begin);
         if (*block_height % 100 == 0 && progress_end - progress_begin > 0.0) {
@@ -2270,7 +2361,7 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
         }
 
         CBlock block;
-        if (chain().findBlock(block_hash, &block) && !block.IsNull()) {
+        if (block_reader->readBlock(block_hash, block) && !block.IsNull()) {
             auto locked_chain = chain().lock();
             LOCK(cs_wallet);
             if (!locked_chain->getBlockHeight(block_hash)) {
@@ -2703,11 +2794,22 @@ CAmount CWallet::GetAnonymizableBalance(bool fSkipDenominated, bool fSkipUnconfi
 {
     if (fLiteMode) return 0;
 
-    std::vector<CompactTallyItem> vecTally;
-    if (!SelectCoinsGroupedByAddresses(vecTally, fSkipDenominated, true, fSkipUnconfirmed)) return 0;
+    auto locked_chain = chain().lock();
+    LOCK(cs_wallet);
+
+    auto& cache = GetBalanceCache(*locked_chain).anonymizable;
+    const auto key = std::make_tuple(fSkipDenominated, fSkipUnconfirmed, privateSendClient.nPrivateSendRounds);
+    auto it = cache.find(key);
+    if (it != cache.end()) return it->second;
 
     CAmount nTotal = 0;
 
+    std::vector<CompactTallyItem> vecTally;
+    if (!SelectCoinsGroupedByAddresses(vecTally, fSkipDenominated, true, fSkipUnconfirmed)) {
+        cache.emplace(key, nTotal);
+        return nTotal;
+    }
+
     const CAmount nSmallestDenom = CPrivateSend::GetSmallestDenomination();
     const CAmount nMixingCollateral = CPrivateSend::GetCollateralAmount();
     for (CompactTallyItem& item : vecTally) {
@@ -2718,6 +2820,7 @@ CAmount CWallet::GetAnonymizableBalance(bool fSkipDenominated, bool fSkipUnconfi
             nTotal += item.nAmount;
     }
 
+    cache.emplace(key, nTotal);
     return nTotal;
 }
 
@@ -2725,14 +2828,19 @@ CAmount CWallet::GetAnonymizedBalance() const
 {
     if (!privateSendClient.fEnablePrivateSend) return 0;
 
-    CAmount nTotal = 0;
-
+    auto locked_chain = chain().lock();
     LOCK2(cs_main, cs_wallet);
 
+    auto& cache = GetBalanceCache(*locked_chain).anonymized;
+    auto it = cache.find(privateSendClient.nPrivateSendRounds);
+    if (it != cache.end()) return it->second;
+
+    CAmount nTotal = 0;
     for (auto pcoin : GetSpendableTXs()) {
         nTotal += pcoin->GetAnonymizedCredit(false);
     }
 
+    cache.emplace(privateSendClient.nPrivateSendRounds, nTotal);
     return nTotal;
 }
 
@@ -2779,17 +2887,21 @@ CAmount CWallet::GetDenominatedBalance(bool unconfirmed) const
 {
     if (fLiteMode) return 0;
 
+    auto locked_chain = chain().lock();
+    LOCK2(cs_main, cs_wallet);
+
+    auto& cache = GetBalanceCache(*locked_chain).denominated;
+    auto itCache = cache.find(unconfirmed);
+    if (itCache != cache.end()) return itCache->second;
+
     CAmount nTotal = 0;
-    {
-        auto locked_chain = chain().lock();
-        LOCK2(cs_main, cs_wallet);
-        for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
-            const CWalletTx* pcoin = &(*it).second;
+    for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
+        const CWalletTx* pcoin = &(*it).second;
 
-            nTotal += pcoin->GetDenominatedCredit(*locked_chain, unconfirmed);
-        }
+        nTotal += pcoin->GetDenominatedCredit(*locked_chain, unconfirmed);
     }
 
+    cache.emplace(unconfirmed, nTotal);
     return nTotal;
 }
 
@@ -2845,6 +2957,10 @@ CWallet::Balance CWallet::GetBalance(const int min_depth, bool avoid_reuse) cons
     {
         auto locked_chain = chain().lock();
         LOCK(cs_wallet);
+        auto& cache = GetBalanceCache(*locked_chain).balance;
+        auto it = cache.find(std::make_pair(min_depth, avoid_reuse));
+        if (it != cache.end()) return it->second;
+
         for (const auto& entry : mapWallet)
         {
             const CWalletTx& wtx = entry.second;
@@ -2863,6 +2979,7 @@ CWallet::Balance CWallet::GetBalance(const int min_depth, bool avoid_reuse) cons
             ret.m_mine_immature += wtx.GetImmatureCredit(*locked_chain);
             ret.m_watchonly_immature += wtx.GetImmatureWatchOnlyCredit(*locked_chain);
         }
+        cache.emplace(std::make_pair(min_depth, avoid_reuse), ret);
     }
     return ret;
 }
@@ -2917,10 +3034,20 @@ void CWallet::AvailableCoins(interfaces::Chain::Lock& locked_chain, std::vector<
     const int min_depth = {coinControl ? coinControl->m_min_depth : DEFAULT_MIN_DEPTH};
     const int max_depth = {coinControl ? coinControl->m_max_depth : DEFAULT_MAX_DEPTH};
 
-    for (const auto& entry : mapWallet)
-    {
-        const uint256& wtxid = entry.first;
-        const CWalletTx& wtx = entry.second;
+    for (auto it = setWalletUTXO.begin(); it != setWalletUTXO.end();) {
+        const uint256 wtxid = it->hash;
+
+        // setWalletUTXO is sorted by COutPoint, which means that all UTXOs for the same TX are neighbors
+        const auto itFirst = it;
+        while (it != setWalletUTXO.end() && it->hash == wtxid) {
+            ++it;
+        }
+
+        const auto jt = mapWallet.find(wtxid);
+        if (jt == mapWallet.end()) {
+            continue;
+        }
+        const CWalletTx& wtx = jt->second;
 
         if (!locked_chain.checkFinalTx(*wtx.tx)) {
             continue;
@@ -2982,7 +3109,8 @@ void CWallet::AvailableCoins(interfaces::Chain::Lock& locked_chain, std::vector<
             continue;
         }
 
-        for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+        for (auto itOutpoint = itFirst; itOutpoint != it; ++itOutpoint) {
+            const unsigned int i = itOutpoint->n;
 
             if (!IsCorrectType(wtx.tx->vout[i].nValue, nCoinType))
                 continue;
@@ -2990,10 +3118,10 @@ void CWallet::AvailableCoins(interfaces::Chain::Lock& locked_chain, std::vector<
             if (wtx.tx->vout[i].nValue < nMinimumAmount || wtx.tx->vout[i].nValue > nMaximumAmount)
                 continue;
 
-            if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(entry.first, i)))
+            if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(*itOutpoint))
                 continue;
 
-            if (IsLockedCoin(entry.first, i) && nCoinType != ONLY_MASTERNODE_COLLATERAL)
+            if (IsLockedCoin(wtxid, i) && nCoinType != ONLY_MASTERNODE_COLLATERAL)
                 continue;
 
             if (IsSpent(locked_chain, wtxid, i))
@@ -3094,27 +3222,37 @@ const CTxOut& CWallet::FindNonChangeParentOutput(const CTransaction& tx, int out
 // ppcoin: total coins staked (non-spendable until maturity)
 CAmount CWallet::GetStake() const
 {
-    CAmount nTotal = 0;
     auto locked_chain = chain().lock();
     LOCK2(cs_main, cs_wallet);
+
+    auto& cache = GetBalanceCache(*locked_chain).stake;
+    if (cache) return *cache;
+
+    CAmount nTotal = 0;
     for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
         const CWalletTx* pcoin = &(*it).second;
         if (pcoin->IsCoinStake() && pcoin->GetBlocksToMaturity(*locked_chain) > 0 && pcoin->GetDepthInMainChain(*locked_chain) > 0)
             nTotal += CWallet::GetCredit(*(pcoin->tx), ISMINE_ALL);
     }
+    cache = nTotal;
     return nTotal;
 }
 
 CAmount CWallet::GetWatchOnlyStake() const
 {
-    CAmount nTotal = 0;
     auto locked_chain = chain().lock();
     LOCK2(cs_main, cs_wallet);
+
+    auto& cache = GetBalanceCache(*locked_chain).watch_only_stake;
+    if (cache) return *cache;
+
+    CAmount nTotal = 0;
     for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
         const CWalletTx* pcoin = &(*it).second;
         if (pcoin->IsCoinStake() && pcoin->GetBlocksToMaturity(*locked_chain) > 0 && pcoin->GetDepthInMainChain(*locked_chain) > 0)
             nTotal += CWallet::GetCredit(*(pcoin->tx), ISMINE_WATCH_ONLY);
     }
+    cache = nTotal;
     return nTotal;
 }
 
@@ -4491,13 +4629,7 @@ DBErrors CWallet::LoadWallet(bool& fFirstRunRet)
         fFirstRunRet = mapKeys.empty() && mapCryptedKeys.empty() && mapWatchKeys.empty() && setWatchOnly.empty() && mapScripts.empty() && !IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS) && !IsWalletFlagSet(WALLET_FLAG_BLANK_WALLET);
     }
 
-    for (auto& pair : mapWallet) {
-        for (unsigned int i = 0; i < pair.second.tx->vout.size(); ++i) {
-            if (IsMine(pair.second.tx->vout[i]) && !IsSpent(*locked_chain, pair.first, i)) {
-                setWalletUTXO.insert(COutPoint(pair.first, i));
-            }
-        }
-    }
+    RebuildWalletUTXO(*locked_chain);
 
     if (nLoadWalletRet != DBErrors::LOAD_OK)
         return nLoadWalletRet;
@@ -4524,16 +4656,27 @@ void CWallet::AutoLockMasternodeCollaterals()
     }
 }
 
-DBErrors CWallet::ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256>& vHashOut)
+DBErrors CWallet::ZapSelectTx(interfaces::Chain::Lock& locked_chain, std::vector<uint256>& vHashIn, std::vector<uint256>& vHashOut)
 {
     AssertLockHeld(cs_wallet);
     DBErrors nZapSelectTxRet = WalletBatch(*database, "cr+").ZapSelectTx(vHashIn, vHashOut);
+    // outputs spent by the zapped transactions may be unspent again
+    std::vector<COutPoint> vPrevouts;
     for (uint256 hash : vHashOut) {
         const auto& it = mapWallet.find(hash);
         wtxOrdered.erase(it->second.m_it_wtxOrdered);
+        for (unsigned int i = 0; i < it->second.tx->vout.size(); ++i) {
+            setWalletUTXO.erase(COutPoint(hash, i));
+        }
+        for (const CTxIn& txin : it->second.tx->vin) {
+            vPrevouts.push_back(txin.prevout);
+        }
         mapWallet.erase(it);
         NotifyTransactionChanged(this, hash, CT_DELETED);
     }
+    for (const COutPoint& prevout : vPrevouts) {
+        UpdateWalletUTXO(locked_chain, prevout);
+    }
 
     if (nZapSelectTxRet == DBErrors::NEED_REWRITE) {
         if (database->Rewrite("\x04pool")) {
@@ -5166,18 +5309,21 @@ void CWallet::LockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet);
     setLockedCoins.insert(output);
+    InvalidateBalanceCache();
 }
 
 void CWallet::UnlockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet);
     setLockedCoins.erase(output);
+    InvalidateBalanceCache();
 }
 
 void CWallet::UnlockAllCoins()
 {
     AssertLockHeld(cs_wallet);
     setLockedCoins.clear();
+    InvalidateBalanceCache();
 }
 
 bool CWallet::IsLockedCoin(uint256 hash, unsigned int n) const
@@ -5922,6 +6068,7 @@ void CWallet::NotifyTransactionLock(const CTransaction& tx, const llmq::CInstant
     uint256 txHash = tx.GetHash();
     std::map<uint256, CWalletTx>::const_iterator mi = mapWallet.find(txHash);
     if (mi != mapWallet.end()) {
+        InvalidateBalanceCache();
         NotifyTransactionChanged(this, txHash, CT_UPDATED);
         NotifyISLockReceived();
 // lets not but say we did
@@ -5936,6 +6083,10 @@ void CWallet::NotifyTransactionLock(const CTransaction& tx, const llmq::CInstant
 
 void CWallet::NotifyChainLock(const CBlockIndex* pindexChainLock, const llmq::CChainLockSig& clsig)
 {
+    {
+        LOCK(cs_wallet);
+        InvalidateBalanceCache();
+    }
     NotifyChainLockReceived(pindexChainLock->nHeight);
 }
 
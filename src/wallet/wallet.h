@@ -43,6 +43,7 @@
 #include <stdexcept>
 #include <stdint.h>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -922,6 +923,12 @@ private:
     //! the maximum wallet format version: memory-only variable that specifies to what version this wallet may be upgraded
     int nWalletMaxVersion GUARDED_BY(cs_wallet) = FEATURE_BASE;
 
+    /**
+     * Outpoints of the wallet's unspent outputs, so that coin enumeration scales with the
+     * number of unspent outputs rather than with the whole transaction history. Entries are
+     * added and removed as transactions are added, updated, abandoned or conflicted;
+     * AvailableCoins still checks each entry, so a stale entry is harmless.
+     */
     std::set<COutPoint> setWalletUTXO;
 
     int64_t nNextResend = 0;
@@ -951,6 +958,17 @@ private:
     void AddToSpends(const COutPoint& outpoint, const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     void AddToSpends(const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
+    /**
+     * PrivateSend rounds of the wallet's outpoints, computed once from their ancestry.
+     * Entries depend on which inputs are in the wallet and ours, so they are dropped when
+     * a parent transaction arrives after its descendants were cached, and by MarkDirty().
+     */
+    mutable std::map<COutPoint, int> mapOutpointRoundsCache GUARDED_BY(cs_wallet);
+    void InvalidatePrivateSendRounds(const uint256& txid) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    /** Add outpoint to setWalletUTXO if it is ours and unspent, remove it otherwise. */
+    void UpdateWalletUTXO(interfaces::Chain::Lock& locked_chain, const COutPoint& outpoint) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     /**
      * Add a transaction to the wallet, or update it.  pIndex and posInBlock should
      * be set when the transaction was known to be included in a block.  When
@@ -1308,6 +1326,8 @@ public:
     DBErrors ReorderTransactions();
 
     void MarkDirty();
+    /** Rebuild setWalletUTXO from all wallet transactions, needed when imported keys or scripts make outputs of known transactions ours. */
+    void RebuildWalletUTXO(interfaces::Chain::Lock& locked_chain) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     bool AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose=true);
     void LoadToWallet(CWalletTx& wtxIn) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     void TransactionAddedToMempool(const CTransactionRef& tx) override;
@@ -1360,6 +1380,34 @@ public:
     float GetAverageAnonymizedRounds() const;
     CAmount GetNormalizedAnonymizedBalance() const;
     CAmount GetDenominatedBalance(bool unconfirmed=false) const;
+
+private:
+    /**
+     * Results of the balance functions above, reused until a wallet transaction changes state
+     * or the chain tip moves. The GUI polls them every second and staking on every attempt,
+     * so most queries are served without walking the wallet.
+     */
+    struct BalanceCache
+    {
+        //! Chain tip the balances were computed at
+        uint256 tip;
+        std::map<std::pair<int, bool>, Balance> balance;
+        Optional<CAmount> stake;
+        Optional<CAmount> watch_only_stake;
+        //! By (fSkipDenominated, fSkipUnconfirmed, PrivateSend rounds)
+        std::map<std::tuple<bool, bool, int>, CAmount> anonymizable;
+        //! By PrivateSend rounds
+        std::map<int, CAmount> anonymized;
+        std::map<bool, CAmount> denominated;
+    };
+    mutable BalanceCache m_balance_cache GUARDED_BY(cs_wallet);
+
+    /** Return the balance cache, emptied first if the chain tip moved since it was filled. */
+    BalanceCache& GetBalanceCache(interfaces::Chain::Lock& locked_chain) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Drop all cached balances. Called whenever a wallet transaction, its state or a coin lock changes. */
+    void InvalidateBalanceCache() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+public:
     bool GetBudgetSystemCollateralTX(CTransactionRef& tx, uint256 hash, CAmount amount, bool fUseInstantSend, const COutPoint& outpoint=COutPoint()/*defaults null*/);
 
     /**
@@ -1475,7 +1523,7 @@ public:
     DBErrors LoadWallet(bool& fFirstRunRet);
     void AutoLockMasternodeCollaterals();
     DBErrors ZapWalletTx(std::vector<CWalletTx>& vWtx);
-    DBErrors ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256>& vHashOut) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    DBErrors ZapSelectTx(interfaces::Chain::Lock& locked_chain, std::vector<uint256>& vHashIn, std::vector<uint256>& vHashOut) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     bool SetAddressBook(const CTxDestination& address, const std::string& strName, const std::string& purpose);
 
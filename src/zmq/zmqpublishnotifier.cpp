@@ -9,6 +9,9 @@
 #include <validation.h>
 #include <util/system.h>
 #include <rpc/server.h>
+#include <sync.h>
+
+#include <memory>
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
@@ -20,6 +23,37 @@ static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWCHAINLOCK  = "rawchainlock";
 static const char *MSG_RAWTX     = "rawtx";
 
+static Mutex cs_last_raw_block;
+static uint256 last_raw_block_hash GUARDED_BY(cs_last_raw_block);
+static std::shared_ptr<const std::vector<uint8_t>> last_raw_block GUARDED_BY(cs_last_raw_block);
+
+/**
+ * Read a block as stored in the block files, which is its network serialization, instead of
+ * deserializing it (and checking its PoW) and serializing it again. The last block read is kept, so
+ * all notifiers publishing the same block (rawblock on several addresses, rawchainlock) share one
+ * buffer.
+ */
+static std::shared_ptr<const std::vector<uint8_t>> ReadRawBlock(const CBlockIndex* pindex)
+{
+    const uint256 hash = pindex->GetBlockHash();
+    {
+        LOCK(cs_last_raw_block);
+        if (last_raw_block && last_raw_block_hash == hash) {
+            return last_raw_block;
+        }
+    }
+
+    auto block_data = std::make_shared<std::vector<uint8_t>>();
+    if (!ReadRawBlockFromDisk(*block_data, pindex, Params().MessageStart())) {
+        return nullptr;
+    }
+
+    LOCK(cs_last_raw_block);
+    last_raw_block_hash = hash;
+    last_raw_block = block_data;
+    return last_raw_block;
+}
+
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
 {
@@ -205,42 +239,26 @@ bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawblock %s\n", pindex->GetBlockHash().GetHex());
 
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-    {
-        LOCK(cs_main);
-        CBlock block;
-        if(!ReadBlockFromDisk(block, pindex, consensusParams))
-        {
-            zmqError("Can't read block from disk");
-            return false;
-        }
-
-        ss << block;
+    std::shared_ptr<const std::vector<uint8_t>> block_data = ReadRawBlock(pindex);
+    if (!block_data) {
+        zmqError("Can't read block from disk");
+        return false;
     }
 
-    return SendMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
+    return SendMessage(MSG_RAWBLOCK, block_data->data(), block_data->size());
 }
 
 bool CZMQPublishRawChainLockNotifier::NotifyChainLock(const CBlockIndex *pindex, const llmq::CChainLockSig& clsig)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawchainlock %s\n", pindex->GetBlockHash().GetHex());
 
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    {
-        LOCK(cs_main);
-        CBlock block;
-        if(!ReadBlockFromDisk(block, pindex, consensusParams))
-        {
-            zmqError("Can't read block from disk");
-            return false;
-        }
-
-        ss << block;
+    std::shared_ptr<const std::vector<uint8_t>> block_data = ReadRawBlock(pindex);
+    if (!block_data) {
+        zmqError("Can't read block from disk");
+        return false;
     }
 
-    return SendMessage(MSG_RAWCHAINLOCK, &(*ss.begin()), ss.size());
+    return SendMessage(MSG_RAWCHAINLOCK, block_data->data(), block_data->size());
 }
 
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
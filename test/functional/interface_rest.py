@@ -324,5 +324,52 @@ class RESTTest (BitcoinTestFramework):
         json_obj = self.test_rest_request("/chaininfo")
         assert_equal(json_obj['bestblockhash'], bb_hash)
 
+        self.log.info("Test the /mnlist and /mnlistdiff URIs")
+
+        zero_hash = '0' * 64
+        base_hash = self.nodes[0].getblockhash(1)
+
+        # There are no masternodes on this chain, the list is empty but refers to the requested block
+        json_obj = self.test_rest_request("/mnlist/{}".format(bb_hash))
+        assert_equal(json_obj['blockHash'], bb_hash)
+        assert_equal(json_obj['masternodes'], [])
+        response_bytes = self.test_rest_request("/mnlist/{}".format(bb_hash), req_type=ReqType.BIN, ret_type=RetType.BYTES)
+        response_hex = self.test_rest_request("/mnlist/{}".format(bb_hash), req_type=ReqType.HEX, ret_type=RetType.BYTES)
+        assert_equal(binascii.hexlify(response_bytes), response_hex.strip(b'\n'))
+
+        # The diff must match the one returned by the RPC interface
+        json_obj = self.test_rest_request("/mnlistdiff/{}/{}".format(base_hash, bb_hash))
+        assert_equal(json_obj, self.nodes[0].protx('diff', base_hash, bb_hash))
+        response_bytes = self.test_rest_request("/mnlistdiff/{}/{}".format(base_hash, bb_hash), req_type=ReqType.BIN, ret_type=RetType.BYTES)
+        response_hex = self.test_rest_request("/mnlistdiff/{}/{}".format(base_hash, bb_hash), req_type=ReqType.HEX, ret_type=RetType.BYTES)
+        assert_greater_than(len(response_bytes), 0)
+        assert_equal(binascii.hexlify(response_bytes), response_hex.strip(b'\n'))
+
+        # Check invalid mnlist and mnlistdiff requests
+        resp = self.test_rest_request("/mnlist/abc", ret_type=RetType.OBJ, status=400)
+        assert_equal(resp.read().decode('utf-8').rstrip(), "Invalid hash: abc")
+        resp = self.test_rest_request("/mnlist/{}".format(zero_hash), ret_type=RetType.OBJ, status=404)
+        assert_equal(resp.read().decode('utf-8').rstrip(), "{} not found".format(zero_hash))
+        self.test_rest_request("/mnlistdiff/{}".format(bb_hash), ret_type=RetType.OBJ, status=400)
+        resp = self.test_rest_request("/mnlistdiff/{}/abc".format(base_hash), req_type=ReqType.HEX, ret_type=RetType.OBJ, status=400)
+        assert_equal(resp.read().decode('utf-8').rstrip(), "Invalid hash: abc")
+        self.test_rest_request("/mnlistdiff/{}/{}".format(base_hash, zero_hash), ret_type=RetType.OBJ, status=404)
+        self.test_rest_request("/mnlistdiff/{}/{}".format(base_hash, zero_hash), req_type=ReqType.HEX, ret_type=RetType.OBJ, status=404)
+
+        self.log.info("Test the /quorum and /recsig URIs")
+
+        # No quorums are formed without masternodes, so only the error paths can be checked here
+        llmq_type = 1  # LLMQ_50_60
+        for uri in ["/quorum", "/recsig"]:
+            for req_type in [ReqType.JSON, ReqType.HEX]:
+                resp = self.test_rest_request("{}/{}/{}".format(uri, llmq_type, zero_hash), req_type=req_type, ret_type=RetType.OBJ, status=404)
+                assert_equal(resp.read().decode('utf-8').rstrip(), "{} not found".format(zero_hash))
+            resp = self.test_rest_request("{}/{}/abc".format(uri, llmq_type), ret_type=RetType.OBJ, status=400)
+            assert resp.read().decode('utf-8').startswith("Invalid hash: abc")
+            resp = self.test_rest_request("{}/255/{}".format(uri, zero_hash), ret_type=RetType.OBJ, status=400)
+            assert resp.read().decode('utf-8').startswith("Invalid LLMQ type: 255")
+            resp = self.test_rest_request("{}/{}".format(uri, zero_hash), ret_type=RetType.OBJ, status=400)
+            assert resp.read().decode('utf-8').startswith("Invalid URI format")
+
 if __name__ == '__main__':
     RESTTest().main()